@@ -0,0 +1,147 @@
+/**
+ * Copyright (c) 2019, Freqchip
+ *
+ * All rights reserved.
+ *
+ *
+ */
+
+/*
+ * INCLUDES
+ */
+#include <stdbool.h>
+#include <string.h>
+
+#include "co_printf.h"
+#include "ANCS_app.h"
+
+/*
+ * MACROS
+ */
+#define ANCS_APP_ENTRY(id, icon, cat, vib)  { id, icon, cat, vib },
+#define ANCS_APP_COUNT(id, icon, cat, vib)  + 1
+
+#define APP_NUM             (0 ANCS_APP_LIST(ANCS_APP_COUNT))
+#define APP_SEED_MAX        0xff
+
+// The hash tables are APP_NUM long and indexed modulo APP_NUM
+#if APP_NUM == 0
+#error "ANCS_APP_LIST needs at least one app"
+#endif
+
+/*
+ * LOCAL VARIABLES
+ */
+static const struct ancs_app app_list[] =
+{
+    ANCS_APP_LIST(ANCS_APP_ENTRY)
+};
+
+static const struct ancs_app app_other =
+{
+    NULL, ANCS_APP_ICON_OTHER, ANCS_APP_CAT_OTHER, ANCS_APP_VIBRATE_SHORT
+};
+
+// Hash and displace: a bundle ID's first hash picks a bucket, the bucket's
+// seed then moves it to a slot of its own. As many slots as apps.
+static uint8_t app_seed[APP_NUM];
+static uint8_t app_slot[APP_NUM];
+static bool app_ready;
+static bool app_linear;             // No seeds found, fall back to a scan
+
+uint32_t ANCS_app_hash(const char *s)
+{
+    uint32_t h = 2166136261u;
+
+    while(*s)
+        h = (h ^ (uint8_t)*s++) * 16777619u;
+    return h;
+}
+
+static uint8_t app_mix(uint32_t h, uint8_t seed)
+{
+    h = (h ^ seed) * 0x2c1b3c6du;
+    h ^= h >> 15;
+    h *= 0x297a2d39u;
+    h ^= h >> 12;
+    return h % APP_NUM;
+}
+
+static bool app_place(uint8_t bucket, uint8_t seed, bool *taken)
+{
+    uint8_t slots[APP_NUM];
+    uint8_t n = 0;
+
+    for(uint8_t i = 0; i < APP_NUM; i++)
+    {
+        uint32_t h = ANCS_app_hash(app_list[i].bundle_id);
+        if(h % APP_NUM != bucket)
+            continue;
+
+        uint8_t slot = app_mix(h, seed);
+        if(taken[slot])
+            return false;
+        for(uint8_t j = 0; j < n; j++)
+        {
+            if(slots[j] == slot)
+                return false;
+        }
+        slots[n++] = slot;
+        app_slot[slot] = i;
+    }
+
+    for(uint8_t j = 0; j < n; j++)
+        taken[slots[j]] = true;
+    return true;
+}
+
+static void app_build(void)
+{
+    bool taken[APP_NUM] = {0};
+    uint8_t size[APP_NUM] = {0};
+
+    for(uint8_t i = 0; i < APP_NUM; i++)
+        size[ANCS_app_hash(app_list[i].bundle_id) % APP_NUM]++;
+
+    // Fullest buckets first, they are the hardest to place
+    for(uint8_t s = APP_NUM; s > 0; s--)
+    {
+        for(uint8_t b = 0; b < APP_NUM; b++)
+        {
+            if(size[b] != s)
+                continue;
+
+            uint16_t seed = 0;
+            while(seed <= APP_SEED_MAX && !app_place(b, seed, taken))
+                seed++;
+            if(seed > APP_SEED_MAX)
+            {
+                co_printf("ANCS app hash failed\r\n");
+                app_linear = true;
+                break;
+            }
+            app_seed[b] = seed;
+        }
+    }
+    app_ready = true;
+}
+
+const struct ancs_app *ANCS_app_lookup(const char *bundle_id)
+{
+    if(!app_ready)
+        app_build();
+
+    if(app_linear)
+    {
+        for(uint8_t i = 0; i < APP_NUM; i++)
+        {
+            if(strcmp(app_list[i].bundle_id, bundle_id) == 0)
+                return &app_list[i];
+        }
+        return &app_other;
+    }
+
+    uint32_t h = ANCS_app_hash(bundle_id);
+    const struct ancs_app *app = &app_list[app_slot[app_mix(h, app_seed[h % APP_NUM])]];
+    return (strcmp(app->bundle_id, bundle_id) == 0) ? app : &app_other;
+}
@@ -0,0 +1,109 @@
+/**
+ * Copyright (c) 2019, Freqchip
+ *
+ * All rights reserved.
+ *
+ * Classify notifications by the app that posted them. The apps known are a
+ * list of bundle IDs, each with the icon, category and vibration pattern the
+ * watch uses for it. Lookup goes through a minimal perfect hash of the list,
+ * one hash of the bundle ID and one compare whatever the list length.
+ *
+ */
+
+#ifndef ANCS_APP_H
+#define ANCS_APP_H
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+
+/*
+ * TYPEDEFS
+ */
+enum ancs_app_icon
+{
+    ANCS_APP_ICON_OTHER,
+    ANCS_APP_ICON_PHONE,
+    ANCS_APP_ICON_SMS,
+    ANCS_APP_ICON_MAIL,
+    ANCS_APP_ICON_CALENDAR,
+    ANCS_APP_ICON_WEIXIN,
+    ANCS_APP_ICON_QQ,
+};
+
+enum ancs_app_category
+{
+    ANCS_APP_CAT_OTHER,
+    ANCS_APP_CAT_CALL,
+    ANCS_APP_CAT_MESSAGE,
+    ANCS_APP_CAT_CHAT,
+    ANCS_APP_CAT_MAIL,
+    ANCS_APP_CAT_SCHEDULE,
+};
+
+enum ancs_app_vibrate
+{
+    ANCS_APP_VIBRATE_NONE,
+    ANCS_APP_VIBRATE_SHORT,
+    ANCS_APP_VIBRATE_DOUBLE,
+    ANCS_APP_VIBRATE_LONG,
+};
+
+struct ancs_app
+{
+    const char *bundle_id;          // NULL for apps not in the list
+    uint8_t icon;
+    uint8_t category;
+    uint8_t vibrate;
+};
+
+/*
+ * MACROS
+ */
+// Known apps, X(bundle id, icon, category, vibrate) each. A project that
+// builds with ANCS_APP_CONFIG defined provides an ancs_app_config.h, a list
+// defined there replaces this one.
+#ifdef ANCS_APP_CONFIG
+#include "ancs_app_config.h"
+#endif
+
+#ifndef ANCS_APP_LIST
+#define ANCS_APP_LIST(X) \
+    X("com.apple.mobilephone",  ANCS_APP_ICON_PHONE,    ANCS_APP_CAT_CALL,      ANCS_APP_VIBRATE_LONG) \
+    X("com.apple.MobileSMS",    ANCS_APP_ICON_SMS,      ANCS_APP_CAT_MESSAGE,   ANCS_APP_VIBRATE_DOUBLE) \
+    X("com.apple.mobilemail",   ANCS_APP_ICON_MAIL,     ANCS_APP_CAT_MAIL,      ANCS_APP_VIBRATE_SHORT) \
+    X("com.apple.mobilecal",    ANCS_APP_ICON_CALENDAR, ANCS_APP_CAT_SCHEDULE,  ANCS_APP_VIBRATE_DOUBLE) \
+    X("com.tencent.xin",        ANCS_APP_ICON_WEIXIN,   ANCS_APP_CAT_CHAT,      ANCS_APP_VIBRATE_SHORT) \
+    X("com.tencent.mqq",        ANCS_APP_ICON_QQ,       ANCS_APP_CAT_CHAT,      ANCS_APP_VIBRATE_SHORT) \
+    X("com.tencent.qq",         ANCS_APP_ICON_QQ,       ANCS_APP_CAT_CHAT,      ANCS_APP_VIBRATE_SHORT)
+#endif
+
+/*
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      ANCS_app_lookup
+ *
+ * @brief   Find the app a bundle ID belongs to.
+ *
+ * @param   bundle_id  - NUL terminated app identifier.
+ *
+ * @return  The app, an entry with bundle_id NULL and the defaults for
+ *          apps not in the list. Never NULL.
+ */
+const struct ancs_app *ANCS_app_lookup(const char *bundle_id);
+
+/*********************************************************************
+ * @fn      ANCS_app_hash
+ *
+ * @brief   Hash of a bundle ID, the one the lookup uses.
+ *
+ * @param   bundle_id  - NUL terminated app identifier.
+ *
+ * @return  32 bit FNV-1a hash.
+ */
+uint32_t ANCS_app_hash(const char *bundle_id);
+
+#endif
@@ -20,7 +20,9 @@
 #include "gatt_sig_uuid.h"
 #include "sys_utils.h"
 #include "ANCS_client.h"
+#include "ANCS_ntf_store.h"
 #include "driver_plf.h"
+#include "os_timer.h"
 
 /*
  * MACROS (궨)
@@ -43,6 +45,7 @@
  * LOCAL VARIABLES (ر)
  */
 uint8_t ANCS_client_id;
+static uint8_t ANCS_client_conidx = 0xff;
 
 #define CTL_POINT_UUID     {0xd9, 0xd9, 0xaa, 0xfd, 0xbd, 0x9b, 0x21, 0x98, \
                                             0xa8, 0x49, 0xe1, 0x45, 0xf3,0xd8, 0xd1, 0x69}
@@ -68,11 +71,6 @@ uint32_t call_notification_uid ;
 uint32_t social_notification_uid ;
 
 
-#define EVENT_ID_NOTIFICATION_ADD       (0)      /**< The arrival of a new iOS notification on the NP */
-#define EVENT_ID_NOTIFICATION_MODIFIED  (1) /**< The modification of an iOS notification on the NP */
-#define EVENT_ID_NOTIFICATION_REMOVED   (2)  /**< The removal of an iOS notification on the NP */
-#define EVENT_ID_NOTIFICATION_RESERVED  (0xff)
-
 #define EVT_FLAG_SILENT         BIT(0)
 #define EVT_FLAG_IMPORTANT      BIT(1)
 #define EVT_FLAG_PRE_EXSITING   BIT(2)
@@ -110,6 +108,381 @@ __PACKED struct ancs_ntf_src
 #define NTF_ATT_ID_POSITIVE_ACT 6
 #define NTF_ATT_ID_NEGATIVE_ACT 7
 
+// Attributes a notification can be asked for, the response carries them
+// back in this order. Title, subtitle and message take a max length, they're
+// asked for no longer than the store keeps. The header is what a summary
+// shows, the rest is only fetched once the notification is opened.
+static const struct
+{
+    uint8_t att_id;
+    uint16_t max_len;
+} ancs_req_atts[] =
+{
+    { NTF_ATT_ID_APPLE,         0 },
+    { NTF_ATT_ID_TITLE,         ANCS_NTF_TITLE_LEN - 1 },
+    { NTF_ATT_ID_SUBTITLE,      ANCS_NTF_SUBTITLE_LEN - 1 },
+    { NTF_ATT_ID_MSG,           ANCS_NTF_MSG_LEN - 1 },
+    { NTF_ATT_ID_MSG_SIZE,      0 },
+    { NTF_ATT_ID_DATE,          0 },
+    { NTF_ATT_ID_POSITIVE_ACT,  0 },
+    { NTF_ATT_ID_NEGATIVE_ACT,  0 },
+};
+#define ANCS_REQ_ATT_NUM    (sizeof(ancs_req_atts) / sizeof(ancs_req_atts[0]))
+#define ANCS_REQ_HEADER_NUM 2
+
+/*
+ * Fetch scheduler. Announced notifications queue up for their header, one
+ * request is in flight at a time and the queue only starts moving
+ * ANCS_FETCH_BATCH_MS after the first announcement of a burst. A UID is queued
+ * once however often it is announced, and only while it is in the store, so
+ * the queue is never longer than the store. Opening a notification puts its
+ * full fetch at the front. When the queue runs dry every app with new
+ * notifications gets one summary.
+ */
+#define ANCS_FETCH_QUEUE_LEN    ANCS_NTF_STORE_NUM
+
+static struct
+{
+    os_timer_t timer;           // Batch window, then the response timeout
+    bool timer_init;
+    bool waiting;               // Batch window running
+    bool busy;                  // A request is in flight
+    bool writing;               // Its write is still unanswered
+    uint8_t write_seq;          // ancs_ctl_sent once it was written
+    uint8_t conidx;
+    uint32_t uid;
+    uint8_t first, last;        // Range of ancs_req_atts asked for
+    uint32_t queue[ANCS_FETCH_QUEUE_LEN];
+    uint8_t head, num;
+} ancs_fetch;
+
+// Control Point write requests sent and answered. Perform Action writes go
+// there too, answers come back in order and the count tells them apart.
+static uint8_t ancs_ctl_sent, ancs_ctl_done;
+
+// New notifications per app since the last summaries, past ANCS_SUMMARY_NUM
+// apps the last one counts all the others
+#define ANCS_SUMMARY_OTHER      0
+
+static struct
+{
+    uint32_t app_hash;
+    uint32_t uid;               // Newest
+    uint8_t count;
+} ancs_summary[ANCS_SUMMARY_NUM];
+static uint8_t ancs_summary_num;
+
+/*
+ * Data Source parser. A response is usually longer than one notification,
+ * the parser keeps its place between them and copies attribute data
+ * straight into the store entry of the request in flight.
+ */
+enum ancs_parse_state
+{
+    PARSE_CMD_ID,
+    PARSE_UID,
+    PARSE_ATT_ID,
+    PARSE_ATT_LEN,
+    PARSE_ATT_DATA,
+    PARSE_ERROR,        // Dropping the rest of a bad response
+};
+
+static struct
+{
+    uint8_t state;
+    uint8_t pos;            // Bytes of the UID or length read so far
+    uint8_t att_idx;        // Into ancs_req_atts
+    uint16_t att_len;
+    uint16_t att_pos;
+    uint32_t uid;
+    struct ancs_ntf *ntf;
+} ancs_parser;
+
+static ANCS_ntf_cb_t ancs_ntf_cb;
+
+static void ANCS_fetch_next(void);
+
+static void ANCS_summary_add(struct ancs_ntf *ntf)
+{
+    uint32_t hash = ANCS_app_hash(ntf->app_id);
+    uint8_t i;
+
+    if(hash == ANCS_SUMMARY_OTHER)
+        hash++;
+    for(i = 0; i < ancs_summary_num; i++)
+    {
+        if(ancs_summary[i].app_hash == hash)
+            break;
+    }
+    if(i == ancs_summary_num)
+    {
+        if(ancs_summary_num < ANCS_SUMMARY_NUM)
+        {
+            ancs_summary_num++;
+            ancs_summary[i].app_hash = hash;
+            ancs_summary[i].count = 0;
+        }
+        else
+        {
+            // More apps than slots, the last one goes on counting for the rest
+            i--;
+            ancs_summary[i].app_hash = ANCS_SUMMARY_OTHER;
+        }
+    }
+    ancs_summary[i].uid = ntf->uid;
+    if(ancs_summary[i].count < 0xff)
+        ancs_summary[i].count++;
+}
+
+static void ANCS_summary_flush(uint8_t conidx)
+{
+    for(uint8_t i = 0; i < ancs_summary_num; i++)
+    {
+        // Skip apps whose notifications are gone again
+        if(ancs_ntf_cb && ANCS_ntf_store_find(ancs_summary[i].uid))
+            ancs_ntf_cb(conidx, ANCS_NTF_EVT_SUMMARY, ancs_summary[i].uid, ancs_summary[i].count);
+    }
+    ancs_summary_num = 0;
+}
+
+static void ANCS_parser_reset(void)
+{
+    ancs_parser.state = PARSE_CMD_ID;
+    ancs_parser.pos = 0;
+    ancs_parser.ntf = NULL;
+}
+
+static void ANCS_parser_error(const char *why)
+{
+    co_printf("ANCS data error:%s,uid:%x\r\n", why, ancs_parser.uid);
+    ancs_parser.ntf = NULL;
+    ancs_parser.state = PARSE_ERROR;
+}
+
+// Drop uid and every UID no longer waiting in the store from the queue
+static void ANCS_queue_purge(uint32_t uid)
+{
+    uint8_t num = 0;
+
+    for(uint8_t i = 0; i < ancs_fetch.num; i++)
+    {
+        uint32_t queued = ancs_fetch.queue[(ancs_fetch.head + i) % ANCS_FETCH_QUEUE_LEN];
+        struct ancs_ntf *ntf = ANCS_ntf_store_find(queued);
+        if(queued != uid && ntf && ntf->queued)
+            ancs_fetch.queue[(ancs_fetch.head + num++) % ANCS_FETCH_QUEUE_LEN] = queued;
+    }
+    ancs_fetch.num = num;
+}
+
+static void ANCS_queue_push(struct ancs_ntf *ntf, bool front)
+{
+    ANCS_queue_purge(ntf->uid);
+    if(ancs_fetch.num == ANCS_FETCH_QUEUE_LEN)
+    {
+        // Can't happen while the queue is as long as the store, but the
+        // push must never fail: the back of the queue gives way
+        struct ancs_ntf *tail;
+        ancs_fetch.num--;
+        tail = ANCS_ntf_store_find(ancs_fetch.queue[(ancs_fetch.head + ancs_fetch.num) % ANCS_FETCH_QUEUE_LEN]);
+        if(tail)
+            tail->queued = false;
+    }
+
+    if(front)
+    {
+        ancs_fetch.head = (ancs_fetch.head + ANCS_FETCH_QUEUE_LEN - 1) % ANCS_FETCH_QUEUE_LEN;
+        ancs_fetch.queue[ancs_fetch.head] = ntf->uid;
+    }
+    else
+    {
+        ancs_fetch.queue[(ancs_fetch.head + ancs_fetch.num) % ANCS_FETCH_QUEUE_LEN] = ntf->uid;
+    }
+    ancs_fetch.num++;
+    ntf->queued = true;
+}
+
+static void ANCS_fetch_timeout(void *arg)
+{
+    ancs_fetch.waiting = false;
+    if(ancs_fetch.busy)
+    {
+        // No answer, give up on this one
+        co_printf("ANCS fetch timeout,uid:%x\r\n", ancs_fetch.uid);
+        ancs_fetch.busy = false;
+        ANCS_parser_reset();
+    }
+    ANCS_fetch_next();
+}
+
+static void ANCS_fetch_done(void)
+{
+    ancs_fetch.busy = false;
+    os_timer_stop(&ancs_fetch.timer);
+    ANCS_fetch_next();
+}
+
+// Queue a notification, now skips the batch window
+static void ANCS_fetch_queue(uint8_t conidx, struct ancs_ntf *ntf, uint8_t want, bool now)
+{
+    if(!ancs_fetch.timer_init)
+    {
+        os_timer_init(&ancs_fetch.timer, ANCS_fetch_timeout, NULL);
+        ancs_fetch.timer_init = true;
+    }
+
+    ancs_fetch.conidx = conidx;
+    if(want > ntf->want)
+        ntf->want = want;
+    if(now || !ntf->queued)
+        ANCS_queue_push(ntf, now);
+
+    if(now)
+        ANCS_fetch_next();
+    else if(!ancs_fetch.busy && !ancs_fetch.waiting)
+    {
+        ancs_fetch.waiting = true;
+        os_timer_start(&ancs_fetch.timer, ANCS_FETCH_BATCH_MS, false);
+    }
+}
+
+static void ANCS_fetch_next(void)
+{
+    struct ancs_ntf *ntf = NULL;
+
+    if(ancs_fetch.busy)
+        return;
+
+    while(ancs_fetch.num)
+    {
+        uint32_t uid = ancs_fetch.queue[ancs_fetch.head];
+        ancs_fetch.head = (ancs_fetch.head + 1) % ANCS_FETCH_QUEUE_LEN;
+        ancs_fetch.num--;
+
+        ntf = ANCS_ntf_store_find(uid);
+        if(ntf && ntf->queued && ntf->fetched < ntf->want)
+            break;
+        ntf = NULL;
+    }
+    if(ntf == NULL)
+    {
+        ANCS_summary_flush(ancs_fetch.conidx);
+        return;
+    }
+
+    // Everything missing up to what's wanted
+    ntf->queued = false;
+    ancs_fetch.first = (ntf->fetched == ANCS_NTF_HEADER) ? ANCS_REQ_HEADER_NUM : 0;
+    ancs_fetch.last = (ntf->want == ANCS_NTF_FULL) ? ANCS_REQ_ATT_NUM : ANCS_REQ_HEADER_NUM;
+    ancs_fetch.uid = ntf->uid;
+    ancs_fetch.waiting = false;
+    ancs_fetch.busy = true;
+
+    uint8_t req[5 + ANCS_REQ_ATT_NUM * 3];
+    uint8_t i = 0;
+    req[i++] = ANCS_CMD_ID_GET_NOTIFICATION_ATTR;   //cmd id
+    req[i++] = ntf->uid & 0xff;                     //ntf_uid
+    req[i++] = (ntf->uid >> 8) & 0xff;
+    req[i++] = (ntf->uid >> 16) & 0xff;
+    req[i++] = (ntf->uid >> 24) & 0xff;
+
+    for(uint8_t n = ancs_fetch.first; n < ancs_fetch.last; n++)
+    {
+        req[i++] = ancs_req_atts[n].att_id;
+        if(ancs_req_atts[n].max_len)
+        {
+            req[i++] = (ancs_req_atts[n].max_len & 0xff);
+            req[i++] = (ancs_req_atts[n].max_len & 0xff00)>>8;
+        }
+    }
+
+    ANCS_gatt_write_req(ancs_fetch.conidx,ANCS_ATT_IDX_CTL_POINT,req,i);
+    ancs_fetch.writing = true;
+    ancs_fetch.write_seq = ancs_ctl_sent;
+    os_timer_start(&ancs_fetch.timer, ANCS_FETCH_TIMEOUT_MS, false);
+}
+
+// Where an attribute goes in the entry, NULL for those only skipped
+static char *ANCS_att_dest(struct ancs_ntf *ntf, uint8_t att_id, uint16_t *size)
+{
+    switch(att_id)
+    {
+        case NTF_ATT_ID_APPLE:
+            *size = sizeof(ntf->app_id);
+            return ntf->app_id;
+        case NTF_ATT_ID_TITLE:
+            *size = sizeof(ntf->title);
+            return ntf->title;
+        case NTF_ATT_ID_SUBTITLE:
+            *size = sizeof(ntf->subtitle);
+            return ntf->subtitle;
+        case NTF_ATT_ID_MSG:
+            *size = sizeof(ntf->msg);
+            return ntf->msg;
+        case NTF_ATT_ID_DATE:
+            *size = sizeof(ntf->date);
+            return ntf->date;
+        default:
+            *size = 0;
+            return NULL;
+    }
+}
+
+static void ANCS_att_byte(struct ancs_ntf *ntf, uint8_t att_id, uint8_t c)
+{
+    // Message size is ASCII decimal
+    if(att_id == NTF_ATT_ID_MSG_SIZE && c >= '0' && c <= '9')
+        ntf->msg_size = ntf->msg_size * 10 + (c - '0');
+}
+
+static void ANCS_att_done(uint8_t conidx)
+{
+    struct ancs_ntf *ntf = ancs_parser.ntf;
+
+    if(ancs_req_atts[ancs_parser.att_idx].att_id == NTF_ATT_ID_APPLE)
+        ntf->app = ANCS_app_lookup(ntf->app_id);
+
+    ancs_parser.att_idx++;
+    ancs_parser.pos = 0;
+    ancs_parser.state = PARSE_ATT_ID;
+    if(ancs_parser.att_idx < ancs_fetch.last)
+        return;
+
+    ANCS_parser_reset();
+    if(ancs_fetch.last == ANCS_REQ_ATT_NUM)
+    {
+        ntf->fetched = ANCS_NTF_FULL;
+        if(ancs_ntf_cb)
+            ancs_ntf_cb(conidx, ANCS_NTF_EVT_OPENED, ntf->uid, 1);
+    }
+    else
+    {
+        ntf->fetched = ANCS_NTF_HEADER;
+        ANCS_summary_add(ntf);
+    }
+    ANCS_fetch_done();
+}
+
+void ANCS_ntf_cb_register(ANCS_ntf_cb_t cb)
+{
+    ancs_ntf_cb = cb;
+}
+
+void ANCS_ntf_open(uint8_t conidx, uint32_t uid)
+{
+    struct ancs_ntf *ntf = ANCS_ntf_store_find(uid);
+
+    if(ntf == NULL)
+        return;
+
+    if(ntf->fetched == ANCS_NTF_FULL)
+    {
+        if(ancs_ntf_cb)
+            ancs_ntf_cb(conidx, ANCS_NTF_EVT_OPENED, uid, 1);
+        return;
+    }
+    ANCS_fetch_queue(conidx, ntf, ANCS_NTF_FULL, true);
+}
+
 void ANCS_recv_ntf_src(uint8_t conidx,uint8_t *p_data, uint16_t len)
 {
     if(len != 8)
@@ -117,6 +490,19 @@ void ANCS_recv_ntf_src(uint8_t conidx,uint8_t *p_data, uint16_t len)
     struct ancs_ntf_src *ntf_src = (struct ancs_ntf_src *)p_data;
     co_printf("event_id:%d,event_flags:%x,category_id:%d,category_cnt:%d,ntf_uid:%x\r\n",ntf_src->event_id
               ,ntf_src->event_flags,ntf_src->category_id,ntf_src->category_cnt,ntf_src->ntf_uid);
+
+    if(ntf_src->event_id == EVENT_ID_NOTIFICATION_REMOVED)
+    {
+        // Its place in the queue is skipped, a reply in flight is dropped
+        if(ANCS_ntf_store_find(ntf_src->ntf_uid))
+        {
+            ANCS_ntf_store_remove(ntf_src->ntf_uid);
+            if(ancs_ntf_cb)
+                ancs_ntf_cb(conidx, ANCS_NTF_EVT_REMOVED, ntf_src->ntf_uid, 0);
+        }
+        goto _exit;
+    }
+
     if( (ntf_src->category_id == CATGRY_ID_SOCIAL
          || ntf_src->category_id == CATGRY_ID_OTHER
          || ntf_src->category_id == CATGRY_ID_INCOMING_CALL
@@ -130,152 +516,177 @@ void ANCS_recv_ntf_src(uint8_t conidx,uint8_t *p_data, uint16_t len)
         if(ntf_src->category_id == CATGRY_ID_MISS_CALL)
             co_printf("Miss call !\r\n");
 
-        if(ntf_src->event_id != EVENT_ID_NOTIFICATION_REMOVED)
+        // A modified notification is fetched again, added or not it's only
+        // queued once
+        struct ancs_ntf *ntf = ANCS_ntf_store_find(ntf_src->ntf_uid);
+        if(ntf == NULL || ntf_src->event_id == EVENT_ID_NOTIFICATION_MODIFIED)
         {
-            co_printf("Send RSP\r\n");
-            uint16_t max_att_len = gatt_get_mtu(conidx)-3;
-            uint8_t rsp[19];
-            uint8_t i = 0;
-            rsp[i++] = ANCS_CMD_ID_GET_NOTIFICATION_ATTR;   //cmd id
-            *(uint32_t *)(rsp + i) = ntf_src->ntf_uid;  //ntf_uid
-            i+=4;
-
-            rsp[i++] = NTF_ATT_ID_APPLE;
-            rsp[i++] = NTF_ATT_ID_TITLE;
-            rsp[i++] = (max_att_len & 0xff);
-            rsp[i++] = (max_att_len & 0xff00)>>8;
-
-            rsp[i++] = NTF_ATT_ID_SUBTITLE;
-            rsp[i++] = (max_att_len & 0xff);
-            rsp[i++] = (max_att_len & 0xff00)>>8;
-
-            rsp[i++] = NTF_ATT_ID_MSG;
-            rsp[i++] = (max_att_len & 0xff);
-            rsp[i++] = (max_att_len & 0xff00)>>8;
-
-            rsp[i++] = NTF_ATT_ID_MSG_SIZE;
-            rsp[i++] = NTF_ATT_ID_DATE;
-            rsp[i++] = NTF_ATT_ID_POSITIVE_ACT;
-            rsp[i++] = NTF_ATT_ID_NEGATIVE_ACT;
-
-            ANCS_gatt_write_req(conidx,ANCS_ATT_IDX_CTL_POINT,rsp,sizeof(rsp));
+            bool queued = ntf && ntf->queued;
+
+            // The reply in flight is for the old content and is written
+            // straight into the entry about to be cleared, drop it
+            if(ntf && ancs_fetch.busy && ancs_fetch.uid == ntf->uid)
+            {
+                ANCS_parser_error("modified");
+                ANCS_fetch_done();
+            }
+            ntf = ANCS_ntf_store_add(ntf_src->ntf_uid);
+            ntf->queued = queued;
         }
+        ntf->event_flags = ntf_src->event_flags;
+        ntf->category_id = ntf_src->category_id;
+
+        // Calls can't wait for the batch
+        ANCS_fetch_queue(conidx, ntf, ANCS_NTF_HEADER,
+                         ntf_src->category_id == CATGRY_ID_INCOMING_CALL);
     }
 _exit:
     ;
 }
-enum ntf_msg_type_t
-{
-    WEIXIN,
-    MOBILE_SMS,
-    MOBILE_PHONE,
-    QQ,
-};
+
 void ANCS_recv_data_src(uint8_t conidx,uint8_t *p_data, uint16_t len)
 {
-    uint8_t *str = NULL;
-    uint16_t str_len = 0;
-    enum ntf_msg_type_t msg_type = 0;
     uint16_t i = 0;
-    uint16_t data_len = 0;
+    bool resync = (ancs_parser.state == PARSE_ERROR);
+
+    // A bad response is dropped up to the end of its notification, the
+    // next one that starts like a response is taken as one
+    if(resync)
+        ANCS_parser_reset();
+
+    // The entry being filled may have been removed or pushed out meanwhile
+    if(ancs_parser.ntf && ANCS_ntf_store_find(ancs_parser.uid) != ancs_parser.ntf)
+    {
+        ANCS_parser_error("gone");
+        ANCS_fetch_done();
+        return;
+    }
 
-    uint8_t event_id = p_data[i++];
-    uint32_t uid = *(uint32_t *)(p_data + i);
-    i+=4;
-    co_printf("evt_id:%d,uid:%x,len:%d\r\n",event_id,uid,len);
     while(i < len)
     {
-        switch(p_data[i++])
+        switch(ancs_parser.state)
         {
-            case NTF_ATT_ID_APPLE:
-                data_len = *(uint16_t *)(p_data + i);
-                i+=2;
-                //show_reg(p_data + i,data_len,1);
-                if( memcmp(p_data+i,"com.tencent.xin",strlen("com.tencent.xin"))==0 )
-                    msg_type = WEIXIN;
-                else if( memcmp(p_data+i,"com.apple.MobileSMS",strlen("com.apple.MobileSMS"))==0 )
-                    msg_type = MOBILE_SMS;
-                else if( memcmp(p_data+i,"com.apple.mobilephone",strlen("com.apple.mobilephone"))==0 )
-                    msg_type = MOBILE_PHONE;
-                else if( memcmp(p_data+i,"com.tencent.mqq",strlen("com.tencent.mqq"))==0 )
-                    msg_type = QQ;
-                else if( memcmp(p_data+i,"com.tencent.qq",strlen("com.tencent.qq"))==0 )
-                    msg_type = QQ;
-                co_printf("NTF_ATT_ID_APPLE,msg_type:%d,len:%d\r\n",msg_type,data_len);
-                i+=data_len;
+            case PARSE_CMD_ID:
+                if(p_data[i++] != ANCS_CMD_ID_GET_NOTIFICATION_ATTR)
+                {
+                    if(resync)
+                        ancs_parser.state = PARSE_ERROR;
+                    else
+                        ANCS_parser_error("cmd id");
+                    return;
+                }
+                ancs_parser.uid = 0;
+                ancs_parser.pos = 0;
+                ancs_parser.state = PARSE_UID;
                 break;
-            case NTF_ATT_ID_TITLE:  //UTF-8
-                data_len = *(uint16_t *)(p_data + i);
-                co_printf("NTF_ATT_ID_TITLE,len:%d\r\n",data_len);
-                i+=2;
-                show_utf8_hex(p_data + i,data_len,1);
-
-                //str = (uint8_t *)(p_data + i);
-                //str_len += data_len;
-
-                i+=data_len;
-                break;
-            case NTF_ATT_ID_SUBTITLE:   //UTF-8
-                data_len = *(uint16_t *)(p_data + i);
-                co_printf("NTF_ATT_ID_SUBTITLE,len:%d\r\n",data_len);
-                i+=2;
-                show_utf8_hex(p_data + i,data_len,1);
-                i+=data_len;
-                break;
-            case NTF_ATT_ID_MSG:    //UTF-8
-                data_len = *(uint16_t *)(p_data + i);
-                co_printf("NTF_ATT_ID_MSG,len:%d\r\n",data_len);
-                i+=2;
-                show_utf8_hex(p_data + i,data_len,1);
-
-                //str = (uint8_t *)(p_data + i);
-                //str_len += data_len;
-
-                i+=data_len;
+            case PARSE_UID:
+                ancs_parser.uid |= (uint32_t)p_data[i++] << (8 * ancs_parser.pos);
+                if(++ancs_parser.pos < 4)
+                    break;
+
+                // Only the answer to the request in flight
+                ancs_parser.ntf = ANCS_ntf_store_find(ancs_parser.uid);
+                if(!ancs_fetch.busy || ancs_parser.uid != ancs_fetch.uid || ancs_parser.ntf == NULL)
+                {
+                    ANCS_parser_error("uid");
+                    // The one in flight was removed, a reply to an older
+                    // request leaves it waiting
+                    if(ancs_fetch.busy && ancs_parser.uid == ancs_fetch.uid)
+                        ANCS_fetch_done();
+                    return;
+                }
+                ancs_parser.att_idx = ancs_fetch.first;
+                ancs_parser.pos = 0;
+                ancs_parser.state = PARSE_ATT_ID;
                 break;
-            case NTF_ATT_ID_MSG_SIZE:   //ASCII
-                data_len = *(uint16_t *)(p_data + i);
-                co_printf("NTF_ATT_ID_MSG_SIZE,len:%d\r\n",data_len);
-                i+=2;
-                show_reg(p_data + i,data_len,1);
-                i+=data_len;
+            case PARSE_ATT_ID:
+                if(p_data[i++] != ancs_req_atts[ancs_parser.att_idx].att_id)
+                {
+                    ANCS_parser_error("att id");
+                    ANCS_fetch_done();
+                    return;
+                }
+                ancs_parser.att_len = 0;
+                ancs_parser.pos = 0;
+                ancs_parser.state = PARSE_ATT_LEN;
                 break;
-            case NTF_ATT_ID_DATE:       //ASCII
-                data_len = *(uint16_t *)(p_data + i);
-                co_printf("NTF_ATT_ID_DATE,len:%d\r\n",data_len);
-                i+=2;
-                show_reg(p_data + i,data_len,1);
-                i+=data_len;
-                break;
-            case NTF_ATT_ID_POSITIVE_ACT:       //UTF-8
-                data_len = *(uint16_t *)(p_data + i);
-                co_printf("NTF_ATT_ID_POSITIVE_ACT,len:%d\r\n",data_len);
-                i+=2;
-                show_utf8_hex(p_data + i,data_len,1);
-                i+=data_len;
+            case PARSE_ATT_LEN:
+            {
+                ancs_parser.att_len |= (uint16_t)p_data[i++] << (8 * ancs_parser.pos);
+                if(++ancs_parser.pos < 2)
+                    break;
+
+                uint16_t max_len = ancs_req_atts[ancs_parser.att_idx].max_len;
+                if(max_len && ancs_parser.att_len > max_len)
+                {
+                    ANCS_parser_error("att len");
+                    ANCS_fetch_done();
+                    return;
+                }
+                ancs_parser.att_pos = 0;
+                ancs_parser.state = PARSE_ATT_DATA;
+                if(ancs_parser.att_len == 0)
+                    ANCS_att_done(conidx);
                 break;
-            case NTF_ATT_ID_NEGATIVE_ACT:       //UTF-8
-                data_len = *(uint16_t *)(p_data + i);
-                co_printf("NTF_ATT_ID_NEGATIVE_ACT,len:%d\r\n",data_len);
-                i+=2;
-                show_utf8_hex(p_data + i,data_len,1);
-                i+=data_len;
+            }
+            case PARSE_ATT_DATA:
+            {
+                uint8_t att_id = ancs_req_atts[ancs_parser.att_idx].att_id;
+                uint16_t take = ancs_parser.att_len - ancs_parser.att_pos;
+                if(take > len - i)
+                    take = len - i;
+
+                // Copied as far as it fits, the terminating NUL included
+                uint16_t size;
+                char *dest = ANCS_att_dest(ancs_parser.ntf, att_id, &size);
+                if(dest && ancs_parser.att_pos < size - 1)
+                {
+                    uint16_t n = size - 1 - ancs_parser.att_pos;
+                    if(n > take)
+                        n = take;
+                    memcpy(dest + ancs_parser.att_pos, p_data + i, n);
+                }
+                else if(dest == NULL)
+                {
+                    for(uint16_t n = 0; n < take; n++)
+                        ANCS_att_byte(ancs_parser.ntf, att_id, p_data[i + n]);
+                }
+
+                i += take;
+                ancs_parser.att_pos += take;
+                if(ancs_parser.att_pos == ancs_parser.att_len)
+                    ANCS_att_done(conidx);
                 break;
+            }
             default:
-                co_printf("ERRR\r\n");
-                break;
+                return;
         }
     }
-    *(str + str_len) = 0;
+}
 
-    if(msg_type == 0)
-    {
-        //ui_show_phone_call(3000,str);
-    }
-    else
-    {
-        //ui_show_chinese_str(msg_type,3000,str);
-    }
+/*********************************************************************
+ * @fn      ANCS_disconnected
+ *
+ * @brief   Forget the fetches, a response cut short by the link going
+ *          down and the stored notifications.
+ *
+ *
+ * @param   None.
+ *
+ * @return  none.
+ */
+void ANCS_disconnected(void)
+{
+    if(ancs_fetch.timer_init)
+        os_timer_stop(&ancs_fetch.timer);
+    ancs_fetch.waiting = false;
+    ancs_fetch.busy = false;
+    ancs_fetch.num = 0;
+    ancs_ctl_sent = ancs_ctl_done = 0;
+    ancs_summary_num = 0;
+    ANCS_parser_reset();
+    // UIDs don't outlive the session
+    ANCS_ntf_store_clear();
 }
 
 /*********************************************************************
@@ -317,8 +728,25 @@ uint16_t ANCS_gatt_msg_handler(gatt_msg_t *p_msg)
         case GATTC_MSG_CMP_EVT:
         {
             co_printf("op:%d done\r\n",p_msg->param.op.operation);
-            if(p_msg->param.op.operation == GATT_OP_PEER_SVC_REGISTERED)
+            if(p_msg->param.op.operation == GATT_OP_WRITE_REQ
+               && p_msg->att_idx == ANCS_ATT_IDX_CTL_POINT)
             {
+                // iOS refuses UIDs it has dropped, no response will come.
+                // Only the answer to the fetch's own write counts.
+                ancs_ctl_done++;
+                if(ancs_fetch.busy && ancs_fetch.writing && ancs_ctl_done == ancs_fetch.write_seq)
+                {
+                    ancs_fetch.writing = false;
+                    if(p_msg->param.op.status != 0)
+                    {
+                        co_printf("ANCS fetch refused:%x,uid:%x\r\n",p_msg->param.op.status,ancs_fetch.uid);
+                        ANCS_fetch_done();
+                    }
+                }
+            }
+            else if(p_msg->param.op.operation == GATT_OP_PEER_SVC_REGISTERED)
+            {
+                ANCS_client_conidx = p_msg->conn_idx;
                 memcpy(ANCS_hdl_cache,p_msg->param.op.arg,6);
                 show_reg((uint8_t *)ANCS_hdl_cache,6,1);
 
@@ -333,6 +761,13 @@ uint16_t ANCS_gatt_msg_handler(gatt_msg_t *p_msg)
             }
         }
         break;
+        case GATTC_MSG_LINK_LOST:
+            if(p_msg->conn_idx == ANCS_client_conidx)
+            {
+                ANCS_client_conidx = 0xff;
+                ANCS_disconnected();
+            }
+            break;
         default:
             break;
     }
@@ -372,6 +807,8 @@ void ANCS_gatt_write_req(uint8_t conidx,enum ancs_att_idx att_idx,uint8_t *p_dat
     write.p_data = p_data;
     write.data_len = len;
     gatt_client_write_req(write);
+    if(att_idx == ANCS_ATT_IDX_CTL_POINT)
+        ancs_ctl_sent++;
 }
 
 void ANCS_gatt_read(uint8_t conidx,enum ancs_att_idx att_idx)
@@ -390,8 +827,10 @@ void ANCS_perform_ntf_act(uint8_t conidx, uint32_t notification_uid, enum ancs_a
         uint8_t rsp[12];
         uint8_t i = 0;
         rsp[i++] = ANCS_CMD_ID_PERFORM_NOTIFICATION_ACTION;   //cmd id
-        *(uint32_t *)(rsp + i) = notification_uid;  //ntf_uid
-        i+=4;
+        rsp[i++] = notification_uid & 0xff;                 //ntf_uid
+        rsp[i++] = (notification_uid >> 8) & 0xff;
+        rsp[i++] = (notification_uid >> 16) & 0xff;
+        rsp[i++] = (notification_uid >> 24) & 0xff;
         rsp[i++] = action_id;
 
         ANCS_gatt_write_req(conidx,ANCS_ATT_IDX_CTL_POINT,rsp,i);
@@ -18,11 +18,17 @@
 #include "gap_api.h"
 #include "gatt_api.h"
 #include "gatt_sig_uuid.h"
+#include "ANCS_ntf_store.h"
 
 
 /*
  * MACROS (궨)
  */
+#define EVENT_ID_NOTIFICATION_ADD       (0)      /**< The arrival of a new iOS notification on the NP */
+#define EVENT_ID_NOTIFICATION_MODIFIED  (1) /**< The modification of an iOS notification on the NP */
+#define EVENT_ID_NOTIFICATION_REMOVED   (2)  /**< The removal of an iOS notification on the NP */
+#define EVENT_ID_NOTIFICATION_RESERVED  (0xff)
+
 #define ANCS_SVC_UUID "\xd0\x00\x2d\x12\x1e\x4b\x0f\xa4\x99\x4e\xce\xb5\x31\xf4\x05\x79"
 /*
  * CONSTANTS ()
@@ -40,6 +46,38 @@ enum ancs_att_idx
     ANCS_ATT_IDX_MAX,
 };
 
+// Announced notifications wait this long for more before their headers
+// are fetched
+#ifndef ANCS_FETCH_BATCH_MS
+#define ANCS_FETCH_BATCH_MS     300
+#endif
+
+// A fetch without an answer is given up after
+#ifndef ANCS_FETCH_TIMEOUT_MS
+#define ANCS_FETCH_TIMEOUT_MS   3000
+#endif
+
+// Apps told apart in one round of summaries
+#ifndef ANCS_SUMMARY_NUM
+#define ANCS_SUMMARY_NUM        4
+#endif
+
+/** @brief Events for the ANCS_ntf_cb_register callback */
+enum ancs_ntf_evt
+{
+    ANCS_NTF_EVT_SUMMARY,   // count new notifications from one app, uid the newest, headers fetched.
+                            // Past ANCS_SUMMARY_NUM apps the last summary counts all the others
+    ANCS_NTF_EVT_OPENED,    // all the attributes of uid fetched after ANCS_ntf_open
+    ANCS_NTF_EVT_REMOVED,   // uid dropped from the store
+};
+
+/**
+ * Notifications are in the store, look them up with ANCS_ntf_store_find.
+ * Summaries come once the fetches queued by a burst are done, at most one
+ * per app.
+ */
+typedef void (*ANCS_ntf_cb_t)(uint8_t conidx, uint8_t evt, uint32_t uid, uint8_t count);
+
 /** @brief ANCS client control command id*/
 enum ancs_cmd_id
 {
@@ -115,6 +153,46 @@ void ANCS_gatt_write_cmd(uint8_t conidx,enum ancs_att_idx att_idx,uint8_t *p_dat
 void ANCS_gatt_write_req(uint8_t conidx,enum ancs_att_idx att_idx,uint8_t *p_data, uint16_t len);
 void ANCS_gatt_read(uint8_t conidx,enum ancs_att_idx att_idx);
 
+/*********************************************************************
+ * @fn      ANCS_ntf_cb_register
+ *
+ * @brief   Set the function told about stored and removed notifications.
+ *
+ *
+ * @param   cb  - callback, NULL for none.
+ *
+ * @return  none.
+ */
+void ANCS_ntf_cb_register(ANCS_ntf_cb_t cb);
+
+/*********************************************************************
+ * @fn      ANCS_ntf_open
+ *
+ * @brief   Fetch the rest of a notification ahead of everything queued,
+ *          ANCS_NTF_EVT_OPENED follows once it's in.
+ *
+ *
+ * @param   conidx  - link idx.
+ *          uid  - notification uid.
+ *
+ * @return  none.
+ */
+void ANCS_ntf_open(uint8_t conidx, uint32_t uid);
+
+/*********************************************************************
+ * @fn      ANCS_disconnected
+ *
+ * @brief   Drops the queued fetches, a half received notification and
+ *          the store, ANCS_gatt_msg_handler calls it when the ANCS link is
+ *          lost.
+ *
+ *
+ * @param   None.
+ *
+ * @return  none.
+ */
+void ANCS_disconnected(void);
+
 
 
 
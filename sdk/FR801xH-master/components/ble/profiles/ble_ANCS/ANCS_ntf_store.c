@@ -0,0 +1,164 @@
+/**
+ * Copyright (c) 2019, Freqchip
+ *
+ * All rights reserved.
+ *
+ *
+ */
+
+/*
+ * INCLUDES
+ */
+#include <string.h>
+
+#include "ANCS_ntf_store.h"
+
+/*
+ * MACROS
+ */
+// iOS hands out UIDs counting up, so the low bits spread them evenly
+#define STORE_HASH_NUM      (ANCS_NTF_STORE_NUM * 2)
+#define STORE_HASH(uid)     ((uid) % STORE_HASH_NUM)
+#define STORE_NONE          0xff
+
+/*
+ * LOCAL VARIABLES
+ */
+static struct ancs_ntf store_ntf[ANCS_NTF_STORE_NUM];
+static bool store_used[ANCS_NTF_STORE_NUM];
+static uint8_t store_chain[ANCS_NTF_STORE_NUM];     // Next slot in the same bucket
+static uint8_t store_bucket[STORE_HASH_NUM];
+static uint8_t store_older[ANCS_NTF_STORE_NUM];     // Age order, both ways
+static uint8_t store_newer[ANCS_NTF_STORE_NUM];
+static uint8_t store_newest;
+static uint8_t store_oldest;
+static uint8_t store_num;
+
+static uint8_t store_lookup(uint32_t uid)
+{
+    uint8_t slot = store_bucket[STORE_HASH(uid)];
+
+    while(slot != STORE_NONE && store_ntf[slot].uid != uid)
+        slot = store_chain[slot];
+    return slot;
+}
+
+static void store_order_unlink(uint8_t slot)
+{
+    if(store_newer[slot] != STORE_NONE)
+        store_older[store_newer[slot]] = store_older[slot];
+    else
+        store_newest = store_older[slot];
+    if(store_older[slot] != STORE_NONE)
+        store_newer[store_older[slot]] = store_newer[slot];
+    else
+        store_oldest = store_newer[slot];
+}
+
+static void store_order_push(uint8_t slot)
+{
+    store_newer[slot] = STORE_NONE;
+    store_older[slot] = store_newest;
+    if(store_newest != STORE_NONE)
+        store_newer[store_newest] = slot;
+    else
+        store_oldest = slot;
+    store_newest = slot;
+}
+
+static void store_unlink(uint8_t slot)
+{
+    uint8_t *p = &store_bucket[STORE_HASH(store_ntf[slot].uid)];
+
+    while(*p != slot)
+        p = &store_chain[*p];
+    *p = store_chain[slot];
+    store_order_unlink(slot);
+    store_used[slot] = false;
+    store_num--;
+}
+
+void ANCS_ntf_store_clear(void)
+{
+    memset(store_used, 0, sizeof(store_used));
+    memset(store_bucket, STORE_NONE, sizeof(store_bucket));
+    store_newest = STORE_NONE;
+    store_oldest = STORE_NONE;
+    store_num = 0;
+}
+
+struct ancs_ntf *ANCS_ntf_store_add(uint32_t uid)
+{
+    uint8_t slot;
+
+    // A cleared store has all buckets at STORE_NONE, zeroed ones aren't
+    if(store_num == 0)
+        ANCS_ntf_store_clear();
+
+    slot = store_lookup(uid);
+    if(slot != STORE_NONE)
+    {
+        store_order_unlink(slot);
+    }
+    else
+    {
+        // A free slot if removals left one, the oldest entry otherwise
+        if(store_num < ANCS_NTF_STORE_NUM)
+        {
+            slot = 0;
+            while(store_used[slot])
+                slot++;
+        }
+        else
+        {
+            slot = store_oldest;
+            store_unlink(slot);
+        }
+
+        uint8_t *bucket = &store_bucket[STORE_HASH(uid)];
+        store_chain[slot] = *bucket;
+        *bucket = slot;
+        store_used[slot] = true;
+        store_num++;
+    }
+    store_order_push(slot);
+
+    memset(&store_ntf[slot], 0, sizeof(struct ancs_ntf));
+    store_ntf[slot].uid = uid;
+    return &store_ntf[slot];
+}
+
+struct ancs_ntf *ANCS_ntf_store_find(uint32_t uid)
+{
+    if(store_num == 0)
+        return NULL;
+
+    uint8_t slot = store_lookup(uid);
+    return (slot == STORE_NONE) ? NULL : &store_ntf[slot];
+}
+
+void ANCS_ntf_store_remove(uint32_t uid)
+{
+    if(store_num == 0)
+        return;
+
+    uint8_t slot = store_lookup(uid);
+    if(slot != STORE_NONE)
+        store_unlink(slot);
+}
+
+uint8_t ANCS_ntf_store_count(void)
+{
+    return store_num;
+}
+
+struct ancs_ntf *ANCS_ntf_store_get(uint8_t index)
+{
+    if(index >= store_num)
+        return NULL;
+
+    uint8_t slot = store_newest;
+    while(index--)
+        slot = store_older[slot];
+    return &store_ntf[slot];
+}
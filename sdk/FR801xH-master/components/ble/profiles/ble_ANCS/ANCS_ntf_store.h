@@ -0,0 +1,149 @@
+/**
+ * Copyright (c) 2019, Freqchip
+ *
+ * All rights reserved.
+ *
+ * Store for the notifications fetched over ANCS. A fixed number of entries
+ * are kept in age order, a new notification takes a free slot and only
+ * replaces the oldest entry once the store is full. Entries are also chained
+ * into a hash table on the UID, so looking one up or dropping it doesn't scan
+ * the store.
+ *
+ */
+
+#ifndef ANCS_NTF_STORE_H
+#define ANCS_NTF_STORE_H
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ANCS_app.h"
+
+/*
+ * MACROS
+ */
+#ifndef ANCS_NTF_STORE_NUM
+#define ANCS_NTF_STORE_NUM      8
+#endif
+
+// Text buffers, longer attributes are cut, always NUL terminated
+#ifndef ANCS_NTF_APP_ID_LEN
+#define ANCS_NTF_APP_ID_LEN     32
+#endif
+#ifndef ANCS_NTF_TITLE_LEN
+#define ANCS_NTF_TITLE_LEN      32
+#endif
+#ifndef ANCS_NTF_SUBTITLE_LEN
+#define ANCS_NTF_SUBTITLE_LEN   32
+#endif
+#ifndef ANCS_NTF_MSG_LEN
+#define ANCS_NTF_MSG_LEN        128
+#endif
+
+// Date is yyyyMMdd'T'HHmmSS
+#define ANCS_NTF_DATE_LEN       16
+
+/*
+ * TYPEDEFS
+ */
+// How much of a notification has been fetched
+enum ancs_ntf_fetch
+{
+    ANCS_NTF_NONE,
+    ANCS_NTF_HEADER,                // App and title
+    ANCS_NTF_FULL,
+};
+
+struct ancs_ntf
+{
+    uint32_t uid;
+    uint8_t event_flags;
+    uint8_t category_id;
+    uint8_t fetched;                // enum ancs_ntf_fetch
+    uint8_t want;                   // What the queued fetch is for
+    bool queued;
+    uint16_t msg_size;              // Full message length, msg may hold less
+    const struct ancs_app *app;     // Set once app_id is in
+    char app_id[ANCS_NTF_APP_ID_LEN];
+    char title[ANCS_NTF_TITLE_LEN];
+    char subtitle[ANCS_NTF_SUBTITLE_LEN];
+    char msg[ANCS_NTF_MSG_LEN];
+    char date[ANCS_NTF_DATE_LEN];
+};
+
+/*
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      ANCS_ntf_store_clear
+ *
+ * @brief   Drop every entry.
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+void ANCS_ntf_store_clear(void);
+
+/*********************************************************************
+ * @fn      ANCS_ntf_store_add
+ *
+ * @brief   Get the entry for a UID, emptied and made the newest. An entry
+ *          already holding the UID is reused, otherwise a free slot is
+ *          taken, or the oldest entry's once the store is full.
+ *
+ * @param   uid  - notification uid.
+ *
+ * @return  The entry, never NULL.
+ */
+struct ancs_ntf *ANCS_ntf_store_add(uint32_t uid);
+
+/*********************************************************************
+ * @fn      ANCS_ntf_store_find
+ *
+ * @brief   Look a notification up by UID.
+ *
+ * @param   uid  - notification uid.
+ *
+ * @return  The entry, NULL if it isn't stored.
+ */
+struct ancs_ntf *ANCS_ntf_store_find(uint32_t uid);
+
+/*********************************************************************
+ * @fn      ANCS_ntf_store_remove
+ *
+ * @brief   Drop a notification, nothing happens if it isn't stored.
+ *
+ * @param   uid  - notification uid.
+ *
+ * @return  None.
+ */
+void ANCS_ntf_store_remove(uint32_t uid);
+
+/*********************************************************************
+ * @fn      ANCS_ntf_store_count
+ *
+ * @brief   Number of entries stored.
+ *
+ * @param   None.
+ *
+ * @return  Entry count.
+ */
+uint8_t ANCS_ntf_store_count(void);
+
+/*********************************************************************
+ * @fn      ANCS_ntf_store_get
+ *
+ * @brief   Walk the entries from the newest, index 0, to the oldest.
+ *
+ * @param   index  - position from the newest.
+ *
+ * @return  The entry, NULL past the oldest.
+ */
+struct ancs_ntf *ANCS_ntf_store_get(uint8_t index);
+
+#endif
@@ -11,6 +11,7 @@
 #include "driver_flash.h"
 #include "driver_wdt.h"
 #include "driver_uart.h"
+#include "os_task.h"
 
 //#include "qspi.h"
 //#include "co_utils.h"
@@ -59,6 +60,8 @@ extern uint8_t app_boot_get_storage_type(void);
 extern void app_boot_save_data(uint32_t dest, uint8_t *src, uint32_t len);
 extern void app_boot_load_data(uint8_t *dest, uint32_t src, uint32_t len);
 extern void system_set_cache_config(uint8_t value, uint8_t count_10us);
+void ota_change_flash_pin(void);
+void ota_recover_flash_pin(void);
 #ifdef OTA_CRC_CHECK
 void os_timer_ota_cb(void *arg);
 #endif
@@ -191,6 +194,53 @@ __attribute__((section("ram_code"))) static void app_otas_save_first_pkt(uint32_
 }
 #endif
 
+// The new image has to boot as newer than the running one
+static void app_otas_update_version(uint8_t *first_page)
+{
+    uint32_t firmware_offset = (uint32_t)&((struct jump_table_t *)0x01000000)->firmware_version- 0x01000000;
+    if( *(uint32_t *)((uint32_t)first_page + firmware_offset) <= app_otas_get_curr_firmwave_version() )
+    {
+        uint32_t new_bin_ver = app_otas_get_curr_firmwave_version() + 1;
+        co_printf("old_ver:%08X\r\n",*(uint32_t *)((uint32_t)first_page + firmware_offset));
+        co_printf("new_ver:%08X\r\n",new_bin_ver);
+        //checksum_minus = new_bin_ver - *(uint32_t *)((uint32_t)first_page + firmware_offset);
+        *(uint32_t *)((uint32_t)first_page + firmware_offset) = new_bin_ver;
+    }
+}
+
+static void app_otas_erase_sector(uint32_t base_address)
+{
+    uint32_t new_bin_base = app_otas_get_storage_address();
+
+    if(base_address == new_bin_base)
+    {
+#ifdef OTA_FOR_FR8012HAQ_J
+        uint8_t * head_pkt = NULL;
+        head_pkt = os_malloc(256);
+        if(head_pkt)
+        {
+            app_otas_flash_read(base_address,head_pkt,256);
+            flash_erase(base_address, 0x1000);
+            app_otas_save_data(base_address,head_pkt,256);
+            os_free(head_pkt);
+        }
+#else
+        for(uint16_t offset = 256; offset < 4096; offset += 256)
+        {
+#ifdef FLASH_PROTECT
+            flash_protect_disable(0);
+#endif
+            flash_page_erase(offset + new_bin_base);
+#ifdef FLASH_PROTECT
+            flash_protect_enable(0);
+#endif
+        }
+#endif
+    }
+    else
+        flash_erase(base_address, 0x1000);
+}
+
 void ota_clr_buffed_pkt(uint8_t conidx)
 {
     //current_conidx = 200;
@@ -202,6 +252,453 @@ void ota_clr_buffed_pkt(uint8_t conidx)
         memset(&first_pkt,0x0,sizeof(first_pkt));
     }
 }
+/*
+ * Streamed download. After OTA_CMD_STREAM_START the phone sends the image as
+ * OTA_CMD_STREAM_DATA write commands numbered from 0, keeping up to
+ * OTA_STREAM_WINDOW of them ahead of the last ack. Data is only copied into
+ * one of two staging buffers in the GATT callback, a full buffer is written
+ * to flash by ota_stream_task while the other one fills, and the sector after
+ * the written data is erased before its data comes in. The first 256 bytes
+ * go to first_pkt as with OTA_CMD_WRITE_DATA, OTA_CMD_REBOOT writes them
+ * after the CRC check.
+ *
+ * Staging buffers end on OTA_STREAM_STAGE_SIZE boundaries of the image, so a
+ * sector is always written by whole buffers.
+ *
+ * Where the project sets OTA_SESSION_SAVE_ADDR, progress is also kept in that
+ * sector so a download survives a lost link or a reset: the image it is for,
+ * from +256 the image header, and from +512 a log the task appends to each
+ * time a sector is complete, how far the image is in flash and its CRC up to
+ * there. A start for the same image erases the sector after the last log
+ * entry again and carries on from there, whatever a reset left in it.
+ */
+#define OTA_STREAM_EVT_FLUSH        1
+#define OTA_STREAM_EVT_ERASE        2
+#define OTA_STREAM_EVT_SESSION      3
+
+#define OTA_STREAM_ACK_EVERY        (OTA_STREAM_WINDOW / 2)
+#define OTA_SECTOR_SIZE             0x1000
+
+#if (OTA_SECTOR_SIZE % OTA_STREAM_STAGE_SIZE) != 0
+#error "OTA_STREAM_STAGE_SIZE has to divide the flash sector size"
+#endif
+
+#ifdef OTA_SESSION_SAVE_ADDR
+#define OTA_SESSION_MAGIC           0x5345534f
+#define OTA_SESSION_HEADER          256
+#define OTA_SESSION_LOG             512
+#define OTA_SESSION_LOG_NUM         ((OTA_SECTOR_SIZE - OTA_SESSION_LOG) / sizeof(struct ota_session_mark))
+
+struct ota_session
+{
+    uint32_t magic;
+    uint32_t base;
+    uint32_t length;
+    uint32_t crc;               // whole image, from OTA_CMD_STREAM_START
+};
+
+struct ota_session_mark
+{
+    uint32_t written;
+    uint32_t crc;
+};
+#endif
+
+static struct ota_stream
+{
+    bool active;
+    bool done;                  // all written and acked
+    bool nacked;                // resend asked for, dropping until it comes
+    bool stalled;               // no room for a packet, resend once a buffer frees
+    bool erase_posted;
+    bool session;               // progress is kept in flash
+    bool header_saved;
+    uint8_t conidx;
+    uint8_t unacked;            // packets taken since the last ack
+    uint16_t next_seq;
+    uint32_t base;              // image start in flash
+    uint32_t length;
+    uint32_t offset;            // bytes taken so far, in order
+    uint32_t written;           // flash holds the image up to here
+    uint32_t erased;            // flash is erased up to here
+    uint32_t crc;               // running CRC of the image from 256 up to written
+    uint32_t image_crc;
+    uint16_t marks;             // session log entries used
+    uint8_t fill;               // staging buffer being filled
+    uint8_t flush;              // oldest buffer handed to the task
+    uint8_t *stage[2];
+    uint32_t stage_addr[2];
+    uint16_t stage_len[2];
+    bool stage_busy[2];         // handed to the task
+} ota_stream;
+static uint16_t ota_stream_task_id = TASK_ID_NONE;
+
+static void ota_stream_post(uint16_t event_id)
+{
+    os_event_t evt;
+
+    evt.event_id = event_id;
+    evt.src_task_id = ota_stream_task_id;
+    evt.param = NULL;
+    evt.param_len = 0;
+    os_msg_post(ota_stream_task_id, &evt);
+}
+
+static void ota_stream_ack(uint8_t result)
+{
+    struct app_ota_rsp_hdr_t rsp;
+    struct app_ota_rsp_hdr_t *rsp_hdr = &rsp;
+
+    rsp_hdr->result = result;
+    rsp_hdr->org_opcode = OTA_CMD_STREAM_DATA;
+    rsp_hdr->length = sizeof(struct stream_ack_rsp);
+    rsp_hdr->rsp.stream_ack.next_seq = ota_stream.next_seq;
+    rsp_hdr->rsp.stream_ack.offset = ota_stream.offset;
+    ota_gatt_report_notify(ota_stream.conidx, (uint8_t *)rsp_hdr,
+                           OTA_HDR_OPCODE_LEN+OTA_HDR_LENGTH_LEN+OTA_HDR_RESULT_LEN+sizeof(struct stream_ack_rsp));
+    ota_stream.unacked = 0;
+}
+
+static void ota_stream_erase_next(void)
+{
+    ota_change_flash_pin();
+    app_otas_erase_sector(ota_stream.erased);
+    ota_recover_flash_pin();
+    wdt_feed();
+    ota_stream.erased += OTA_SECTOR_SIZE;
+}
+
+static void ota_session_open(void)
+{
+#ifdef OTA_SESSION_SAVE_ADDR
+    struct ota_session session;
+
+    session.magic = OTA_SESSION_MAGIC;
+    session.base = ota_stream.base;
+    session.length = ota_stream.length;
+    session.crc = ota_stream.image_crc;
+    ota_change_flash_pin();
+    flash_erase(OTA_SESSION_SAVE_ADDR, OTA_SECTOR_SIZE);
+    app_otas_save_data(OTA_SESSION_SAVE_ADDR, (uint8_t *)&session, sizeof(session));
+    ota_recover_flash_pin();
+#endif
+}
+
+static void ota_session_mark(void)
+{
+#ifdef OTA_SESSION_SAVE_ADDR
+    struct ota_session_mark mark;
+
+    ota_change_flash_pin();
+    if(!ota_stream.header_saved)
+    {
+        app_otas_save_data(OTA_SESSION_SAVE_ADDR + OTA_SESSION_HEADER, first_pkt.buf, 256);
+        ota_stream.header_saved = true;
+    }
+    // With the log full a resume starts from its last entry
+    if(ota_stream.marks < OTA_SESSION_LOG_NUM)
+    {
+        mark.written = ota_stream.written;
+        mark.crc = ota_stream.crc;
+        app_otas_save_data(OTA_SESSION_SAVE_ADDR + OTA_SESSION_LOG + ota_stream.marks * sizeof(mark),
+                           (uint8_t *)&mark, sizeof(mark));
+        ota_stream.marks++;
+    }
+    ota_recover_flash_pin();
+#endif
+}
+
+static void ota_session_clear(void)
+{
+#ifdef OTA_SESSION_SAVE_ADDR
+    ota_change_flash_pin();
+    flash_erase(OTA_SESSION_SAVE_ADDR, OTA_SECTOR_SIZE);
+    ota_recover_flash_pin();
+#endif
+}
+
+// Pick up where a session for the same image got to
+static bool ota_session_resume(void)
+{
+#ifdef OTA_SESSION_SAVE_ADDR
+    struct ota_session session;
+    struct ota_session_mark mark, last = {0, 0};
+    uint16_t i;
+
+    app_boot_load_data((uint8_t *)&session, OTA_SESSION_SAVE_ADDR, sizeof(session));
+    if(session.magic != OTA_SESSION_MAGIC || session.base != ota_stream.base
+       || session.length != ota_stream.length || session.crc != ota_stream.image_crc)
+        return false;
+
+    for(i = 0; i < OTA_SESSION_LOG_NUM; i++)
+    {
+        app_boot_load_data((uint8_t *)&mark, OTA_SESSION_SAVE_ADDR + OTA_SESSION_LOG + i * sizeof(mark), sizeof(mark));
+        // Marks sit on sector boundaries or at the end, one that isn't
+        // was cut short by a reset
+        if(mark.written == 0xffffffff
+           || ((mark.written - ota_stream.base) % OTA_SECTOR_SIZE != 0
+               && mark.written != ota_stream.base + ota_stream.length))
+            break;
+        last = mark;
+    }
+    if(i == 0 || last.written <= ota_stream.written || last.written > ota_stream.base + ota_stream.length)
+        return false;
+
+    app_boot_load_data(first_pkt.buf, OTA_SESSION_SAVE_ADDR + OTA_SESSION_HEADER, 256);
+    first_pkt.len = 256;
+    ota_stream.header_saved = true;
+    ota_stream.marks = i;
+    ota_stream.written = last.written;
+    ota_stream.crc = last.crc;
+    ota_stream.offset = last.written - ota_stream.base;
+    // The next sector may be partly programmed, it is erased again
+    ota_stream.erased = last.written;
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Erase one sector ahead of the written data, never past the image
+static void ota_stream_erase_ahead(void)
+{
+    if(ota_stream.erase_posted)
+        return;
+    if(ota_stream.erased < ota_stream.base + ota_stream.length &&
+       ota_stream.erased < ota_stream.written + OTA_SECTOR_SIZE)
+    {
+        ota_stream.erase_posted = true;
+        ota_stream_post(OTA_STREAM_EVT_ERASE);
+    }
+}
+
+static void ota_stream_flush(void)
+{
+    uint8_t idx = ota_stream.flush;
+
+    if(!ota_stream.stage_busy[idx])
+        return;
+
+    uint32_t end = ota_stream.stage_addr[idx] + ota_stream.stage_len[idx];
+    while(ota_stream.erased < end)
+        ota_stream_erase_next();
+
+    ota_change_flash_pin();
+    app_otas_save_data(ota_stream.stage_addr[idx], ota_stream.stage[idx], ota_stream.stage_len[idx]);
+    ota_recover_flash_pin();
+    wdt_feed();
+
+#ifdef OTA_CRC_CHECK
+    ota_stream.crc = Crc32CalByByte(ota_stream.crc, ota_stream.stage[idx], ota_stream.stage_len[idx]);
+#endif
+    ota_stream.written = end;
+    if(ota_stream.session
+       && ((end - ota_stream.base) % OTA_SECTOR_SIZE == 0 || end == ota_stream.base + ota_stream.length))
+        ota_session_mark();
+    ota_stream.stage_len[idx] = 0;
+    ota_stream.stage_busy[idx] = false;
+    ota_stream.flush ^= 1;
+
+    if(ota_stream.written == ota_stream.base + ota_stream.length)
+    {
+#ifdef OTA_CRC_CHECK
+        if(ota_stream.crc != ota_stream.image_crc)
+        {
+            // Not the image announced, a new start has to send it all again
+            co_printf("ota stream crc fail\r\n");
+            if(ota_stream.session)
+                ota_session_clear();
+            ota_stream_ack(OTA_RSP_ERROR);
+            ota_stream.active = false;
+            return;
+        }
+#endif
+        ota_stream.done = true;
+        ota_stream_ack(OTA_RSP_SUCCESS);
+    }
+    else if(ota_stream.stalled)
+    {
+        ota_stream.stalled = false;
+        ota_stream_ack(OTA_RSP_ERROR);
+    }
+}
+
+// Flash work is one erase or one buffer per event, so the stack runs in between
+static int ota_stream_task(os_event_t *param)
+{
+    if(!ota_stream.active)
+        return EVT_CONSUMED;
+
+    switch(param->event_id)
+    {
+        case OTA_STREAM_EVT_FLUSH:
+            ota_stream_flush();
+            break;
+        case OTA_STREAM_EVT_ERASE:
+            ota_stream.erase_posted = false;
+            if(ota_stream.erased < ota_stream.base + ota_stream.length)
+                ota_stream_erase_next();
+            break;
+        case OTA_STREAM_EVT_SESSION:
+            ota_session_open();
+            break;
+    }
+    ota_stream_erase_ahead();
+
+    return EVT_CONSUMED;
+}
+
+static void ota_stream_hand_over(void)
+{
+    ota_stream.stage_busy[ota_stream.fill] = true;
+    ota_stream.fill ^= 1;
+    ota_stream_post(OTA_STREAM_EVT_FLUSH);
+}
+
+static uint16_t ota_stream_room(void)
+{
+    uint8_t idx = ota_stream.fill;
+
+    if(ota_stream.stage_busy[idx])
+        return 0;
+    // Up to the boundary the buffer being filled ends on, first_pkt included
+    return OTA_STREAM_STAGE_SIZE - ota_stream.offset % OTA_STREAM_STAGE_SIZE
+           + (ota_stream.stage_busy[idx ^ 1] ? 0 : OTA_STREAM_STAGE_SIZE);
+}
+
+static void ota_stream_take(uint8_t *data, uint16_t len)
+{
+    if(ota_stream.offset < 256)
+    {
+        uint16_t n = 256 - ota_stream.offset;
+        if(n > len)
+            n = len;
+        memcpy(first_pkt.buf + first_pkt.len, data, n);
+        first_pkt.len += n;
+        ota_stream.offset += n;
+        data += n;
+        len -= n;
+        if(first_pkt.len == 256)
+            app_otas_update_version(first_pkt.buf);
+    }
+
+    while(len)
+    {
+        uint8_t idx = ota_stream.fill;
+        uint16_t n = OTA_STREAM_STAGE_SIZE - ota_stream.offset % OTA_STREAM_STAGE_SIZE;
+        if(n > len)
+            n = len;
+        if(ota_stream.stage_len[idx] == 0)
+            ota_stream.stage_addr[idx] = ota_stream.base + ota_stream.offset;
+        memcpy(ota_stream.stage[idx] + ota_stream.stage_len[idx], data, n);
+        ota_stream.stage_len[idx] += n;
+        ota_stream.offset += n;
+        data += n;
+        len -= n;
+        if(ota_stream.offset % OTA_STREAM_STAGE_SIZE == 0)
+            ota_stream_hand_over();
+    }
+
+    if(ota_stream.offset == ota_stream.length && ota_stream.stage_len[ota_stream.fill] != 0)
+        ota_stream_hand_over();
+}
+
+static void ota_stream_data(struct app_ota_cmd_hdr_t *cmd_hdr, uint16_t len)
+{
+    uint16_t hdr_len = OTA_HDR_OPCODE_LEN+OTA_HDR_LENGTH_LEN+sizeof(struct stream_data_cmd);
+
+    if(!ota_stream.active || ota_stream.done)
+        return;
+    // A short or mangled packet counts as lost
+    if(len < hdr_len || cmd_hdr->length != len - hdr_len)
+        return;
+
+    uint16_t ahead = cmd_hdr->cmd.stream_data.seq - ota_stream.next_seq;
+    if(ahead != 0)
+    {
+        // Behind is a resent copy, ahead means one got lost: ask once, then
+        // drop the rest of the window until the resend comes
+        if(ahead < 0x8000 && !ota_stream.nacked)
+        {
+            ota_stream.nacked = true;
+            ota_stream_ack(OTA_RSP_ERROR);
+        }
+        return;
+    }
+
+    uint16_t data_len = cmd_hdr->length;
+    if(data_len > ota_stream.length - ota_stream.offset)
+    {
+        co_printf("ota stream overrun\r\n");
+        gap_disconnect_req(ota_stream.conidx);
+        return;
+    }
+    if(data_len > ota_stream_room())
+    {
+        ota_stream.nacked = true;
+        ota_stream.stalled = true;
+        return;
+    }
+
+    ota_stream.nacked = false;
+    ota_stream_take((uint8_t *)cmd_hdr + hdr_len, data_len);
+    ota_stream.next_seq++;
+    // The last ack comes once everything is in flash
+    if(++ota_stream.unacked >= OTA_STREAM_ACK_EVERY && ota_stream.offset != ota_stream.length)
+        ota_stream_ack(OTA_RSP_SUCCESS);
+}
+
+static void ota_stream_end(void)
+{
+    if(ota_stream.stage[0] != NULL)
+        os_free(ota_stream.stage[0]);
+    memset(&ota_stream, 0, sizeof(ota_stream));
+}
+
+static uint8_t ota_stream_start(uint8_t conidx, struct stream_start_cmd *cmd)
+{
+    uint32_t base_address = cmd->base_address;
+    uint32_t length = cmd->length;
+
+    ota_stream_end();
+    if(base_address != app_otas_get_storage_address()
+       || length <= 256 || length > app_otas_get_image_size())
+        return OTA_RSP_ERROR;
+
+    if(first_pkt.buf != NULL)
+        os_free(first_pkt.buf);
+    first_pkt.buf = os_malloc(256);
+    first_pkt.malloced_pkt_num = 1;
+    first_pkt.len = 0;
+    ota_stream.stage[0] = os_malloc(OTA_STREAM_STAGE_SIZE * 2);
+    ota_stream.stage[1] = ota_stream.stage[0] + OTA_STREAM_STAGE_SIZE;
+
+    if(ota_stream_task_id == TASK_ID_NONE)
+        ota_stream_task_id = os_task_create(ota_stream_task);
+
+    ota_stream.conidx = conidx;
+    ota_stream.base = base_address;
+    ota_stream.length = length;
+    ota_stream.image_crc = cmd->crc;
+    ota_stream.written = base_address + 256;
+    ota_stream.erased = base_address;
+    ota_stream.active = true;
+#ifdef OTA_SESSION_SAVE_ADDR
+    // Never inside the image halves
+    ota_stream.session = (OTA_SESSION_SAVE_ADDR >= app_otas_get_image_size() * 2);
+#endif
+    if(ota_stream.session && ota_session_resume())
+    {
+        co_printf("ota resume at %x\r\n", ota_stream.offset);
+        ota_stream.done = (ota_stream.written == base_address + length);
+    }
+    else if(ota_stream.session)
+        ota_stream_post(OTA_STREAM_EVT_SESSION);
+    ota_stream_erase_ahead();
+
+    return OTA_RSP_SUCCESS;
+}
+
 void ota_init(uint8_t conidx)
 {
     app_otas_status.read_opcode = OTA_CMD_NULL;
@@ -213,6 +710,7 @@ void ota_init(uint8_t conidx)
 }
 void ota_deinit(uint8_t conidx)
 {
+    ota_stream_end();
     ota_clr_buffed_pkt(conidx);
     app_set_ota_state(0);
     if(ota_recving_buffer != NULL) {
@@ -283,8 +781,10 @@ void app_otas_recv_data(uint8_t conidx,uint8_t *p_data,uint16_t len)
         ota_start();
 #endif		
     }
+#ifdef OTA_DEBUG
     co_printf("app_otas_recv_data[%d]: %d, %d. %d\r\n",at_data_idx, gatt_get_mtu(conidx), len, cmd_hdr->cmd.write_data.length);
     show_reg(p_data,sizeof(struct app_ota_cmd_hdr_t),1);
+#endif
 #ifdef OTA_CRC_CHECK	
     os_timer_stop(&os_timer_ota);
     os_timer_start(&os_timer_ota, OTA_TIMEOUT, 0);
@@ -304,7 +804,14 @@ void app_otas_recv_data(uint8_t conidx,uint8_t *p_data,uint16_t len)
         p_data = ota_recving_buffer;
         cmd_hdr = (struct app_ota_cmd_hdr_t *)ota_recving_buffer;
     }
-    
+
+    // Image data is only copied here, ota_stream_task writes it
+    if(cmd_hdr->opcode == OTA_CMD_STREAM_DATA)
+    {
+        ota_stream_data(cmd_hdr, len);
+        return;
+    }
+
     ota_change_flash_pin();
     wdt_feed();
 
@@ -363,6 +870,9 @@ void app_otas_recv_data(uint8_t conidx,uint8_t *p_data,uint16_t len)
             ota_recving_data = true;
             ota_recover_flash_pin();
             return;
+        case OTA_CMD_STREAM_START:
+            rsp_data_len += sizeof(struct stream_start_rsp);
+            break;
     }
 
     struct otas_send_rsp *req = os_malloc(sizeof(struct otas_send_rsp) + rsp_data_len);
@@ -392,7 +902,6 @@ void app_otas_recv_data(uint8_t conidx,uint8_t *p_data,uint16_t len)
         case OTA_CMD_PAGE_ERASE:
         {
             rsp_hdr->rsp.page_erase.base_address = cmd_hdr->cmd.page_erase.base_address;
-            uint32_t new_bin_base = app_otas_get_storage_address();
 #if 1
             ///co_printf("cur_code_addr:%x\r\n",new_bin_base);
             if( app_otas_get_curr_code_address() == 0 )
@@ -412,33 +921,7 @@ void app_otas_recv_data(uint8_t conidx,uint8_t *p_data,uint16_t len)
                 }
             }
 #endif
-            if(rsp_hdr->rsp.page_erase.base_address == new_bin_base)
-            {
-#ifdef OTA_FOR_FR8012HAQ_J
-                uint8_t * head_pkt = NULL;
-                head_pkt = os_malloc(256);
-                if(head_pkt)
-                {
-                    app_otas_flash_read(rsp_hdr->rsp.page_erase.base_address,head_pkt,256);
-                    flash_erase(rsp_hdr->rsp.page_erase.base_address, 0x1000);
-                    app_otas_save_data(rsp_hdr->rsp.page_erase.base_address,head_pkt,256);
-                    os_free(head_pkt);
-                }
-#else                
-                for(uint16_t offset = 256; offset < 4096; offset += 256)
-                {
-#ifdef FLASH_PROTECT
-                    flash_protect_disable(0);
-#endif	
-                    flash_page_erase(offset + new_bin_base);
-#ifdef FLASH_PROTECT
-                    flash_protect_enable(0);
-#endif
-                }
-#endif                
-            }
-            else
-                flash_erase(rsp_hdr->rsp.page_erase.base_address, 0x1000);
+            app_otas_erase_sector(rsp_hdr->rsp.page_erase.base_address);
         }
         break;
         case OTA_CMD_CHIP_ERASE:
@@ -488,15 +971,7 @@ void app_otas_recv_data(uint8_t conidx,uint8_t *p_data,uint16_t len)
                     //change firmware version in buffed pkt.
                     if(first_pkt.len >= rsp_hdr->rsp.write_data.length * first_pkt.malloced_pkt_num)
                     {
-                        uint32_t firmware_offset = (uint32_t)&((struct jump_table_t *)0x01000000)->firmware_version- 0x01000000;
-                        if( *(uint32_t *)((uint32_t)first_pkt.buf + firmware_offset) <= app_otas_get_curr_firmwave_version() )
-                        {
-                            uint32_t new_bin_ver = app_otas_get_curr_firmwave_version() + 1;
-                            co_printf("old_ver:%08X\r\n",*(uint32_t *)((uint32_t)first_pkt.buf + firmware_offset));
-                            co_printf("new_ver:%08X\r\n",new_bin_ver);
-                            //checksum_minus = new_bin_ver - *(uint32_t *)((uint32_t)first_pkt.buf + firmware_offset);
-                            *(uint32_t *)((uint32_t)first_pkt.buf + firmware_offset) = new_bin_ver;
-                        }
+                        app_otas_update_version(first_pkt.buf);
                         //write data from 256 ~ rsp_hdr->rsp.write_data.length * first_pkt.malloced_pkt_num
                         app_otas_save_data(new_bin_base + 256,first_pkt.buf + 256,first_pkt.len - 256);
                     }
@@ -537,12 +1012,35 @@ void app_otas_recv_data(uint8_t conidx,uint8_t *p_data,uint16_t len)
                        rsp_hdr->rsp.read_data.length);
             }
             break;
+        case OTA_CMD_STREAM_START:
+            rsp_hdr->rsp.stream_start.base_address = cmd_hdr->cmd.stream_start.base_address;
+            rsp_hdr->rsp.stream_start.window = OTA_STREAM_WINDOW;
+            rsp_hdr->result = ota_stream_start(conidx,&cmd_hdr->cmd.stream_start);
+            rsp_hdr->rsp.stream_start.offset = ota_stream.offset;
+            break;
         case OTA_CMD_REBOOT:
+            if(ota_stream.active && !ota_stream.done)
+            {
+                // still writing, the phone has to wait for the last ack
+                rsp_hdr->result = OTA_RSP_ERROR;
+                break;
+            }
             if(first_pkt.buf != NULL)
             {
                 uint32_t new_bin_base = app_otas_get_storage_address();
 #ifdef OTA_CRC_CHECK
-                if(app_otas_crc_cal(cmd_hdr->cmd.fir_crc_data.firmware_length,new_bin_base,cmd_hdr->cmd.fir_crc_data.CRC32_data)){
+                uint8_t crc_ok;
+                if(ota_stream.done)
+                {
+                    // summed while the stream was written, no need to read the image back
+                    crc_ok = (cmd_hdr->cmd.fir_crc_data.firmware_length == ota_stream.length)
+                             && (cmd_hdr->cmd.fir_crc_data.CRC32_data == ota_stream.crc);
+                    if(ota_stream.session)
+                        ota_session_clear();
+                }
+                else
+                    crc_ok = app_otas_crc_cal(cmd_hdr->cmd.fir_crc_data.firmware_length,new_bin_base,cmd_hdr->cmd.fir_crc_data.CRC32_data);
+                if(crc_ok){
 #endif			   
 #ifdef OTA_FOR_FR8012HAQ_J
                 co_printf("crc32 check success\r\n");
@@ -562,6 +1060,9 @@ void app_otas_recv_data(uint8_t conidx,uint8_t *p_data,uint16_t len)
                 }
                 else{
                     co_printf("crc32 check fail\r\n\r\n");
+                    // or the next start would resume the same bad image
+                    if(ota_stream.session)
+                        ota_session_clear();
                     os_free(req);
                     ota_stop(OTA_CHECK_FAIL);
                     platform_reset_patch(0);
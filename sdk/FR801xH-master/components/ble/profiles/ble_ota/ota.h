@@ -12,6 +12,15 @@
 #define OTA_TIMEOUT  5000
 #endif
 //#define OTA_FOR_FR8012HAQ_J
+//#define OTA_DEBUG                 // log every received packet
+
+// Streamed download, see OTA_CMD_STREAM_START
+#ifndef OTA_STREAM_WINDOW
+#define OTA_STREAM_WINDOW           8       // packets the phone may send ahead of the last ack
+#endif
+#ifndef OTA_STREAM_STAGE_SIZE
+#define OTA_STREAM_STAGE_SIZE       1024    // each of the two flash staging buffers
+#endif
 typedef enum 
 {
     OTA_CMD_NVDS_TYPE,
@@ -25,6 +34,8 @@ typedef enum
     OTA_CMD_READ_MEM,
     OTA_CMD_REBOOT,
     OTA_CMD_NULL,
+    OTA_CMD_STREAM_START,   //start a streamed download of the whole image
+    OTA_CMD_STREAM_DATA,    //numbered image data, acked every few packets
 }ota_cmd_t;
 
 typedef enum 
@@ -89,6 +100,23 @@ __PACKED struct read_data_rsp
     uint16_t length;
 }GCC_PACKED;
 
+// offset is where the phone carries on from, 0 unless an earlier session is resumed
+__PACKED struct stream_start_rsp
+{
+    uint32_t base_address;
+    uint16_t window;
+    uint32_t offset;
+}GCC_PACKED;
+
+// result OTA_RSP_SUCCESS acks up to next_seq, OTA_RSP_ERROR asks to resend from it.
+// Once offset reaches the image length an OTA_RSP_ERROR means the CRC didn't
+// match the one in stream_start_cmd and the stream is over.
+__PACKED struct stream_ack_rsp
+{
+    uint16_t next_seq;
+    uint32_t offset;
+}GCC_PACKED;
+
 __PACKED struct app_ota_rsp_hdr_t
 {
     uint8_t result;
@@ -104,6 +132,8 @@ __PACKED struct app_ota_rsp_hdr_t
         struct read_mem_rsp read_mem;
         struct write_data_rsp write_data;
         struct read_data_rsp read_data;
+        struct stream_start_rsp stream_start;
+        struct stream_ack_rsp stream_ack;
     }GCC_PACKED rsp;
 }GCC_PACKED;
 
@@ -136,6 +166,19 @@ __PACKED struct read_data_cmd
     uint16_t length;
 }GCC_PACKED;
 
+__PACKED struct stream_start_cmd
+{
+    uint32_t base_address;
+    uint32_t length;        //whole image
+    uint32_t crc;           //as sent with OTA_CMD_REBOOT, tells a resumable session apart
+}GCC_PACKED;
+
+// length in the header is the data following seq
+__PACKED struct stream_data_cmd
+{
+    uint16_t seq;
+}GCC_PACKED;
+
 #ifdef OTA_CRC_CHECK
 __PACKED struct firmware_check
 {
@@ -155,6 +198,8 @@ __PACKED struct app_ota_cmd_hdr_t
         struct read_mem_cmd read_mem;
         struct write_data_cmd write_data;
         struct read_data_cmd read_data;
+        struct stream_start_cmd stream_start;
+        struct stream_data_cmd stream_data;
 #ifdef OTA_CRC_CHECK		
         struct firmware_check fir_crc_data;
 #endif		
@@ -23,6 +23,7 @@
 
 #ifdef FOR_8M_FLASH
 	#define JUMP_TABLE_STATIC_KEY_OFFSET    0xFF000
+	#define OTA_SESSION_SAVE_ADDR           0xFC000
 	#define BLE_BONDING_INFO_SAVE_ADDR      0xFD000
 	#define BLE_REMOTE_SERVICE_SAVE_ADDR    0xFE000
     #define FLASH_MAX_SIZE                  0x100000
@@ -30,6 +31,7 @@
 
 #ifdef FOR_4M_FLASH
 	#define JUMP_TABLE_STATIC_KEY_OFFSET    0x7F000
+	#define OTA_SESSION_SAVE_ADDR           0x7C000
 	#define BLE_BONDING_INFO_SAVE_ADDR      0x7D000
 	#define BLE_REMOTE_SERVICE_SAVE_ADDR    0x7E000
     #define FLASH_MAX_SIZE                  0x80000
@@ -37,6 +39,7 @@
 
 #ifdef FOR_2M_FLASH
 	#define JUMP_TABLE_STATIC_KEY_OFFSET    0x3F000
+	#define OTA_SESSION_SAVE_ADDR           0x3C000
 	#define BLE_BONDING_INFO_SAVE_ADDR      0x3D000
 	#define BLE_REMOTE_SERVICE_SAVE_ADDR    0x3E000
     #define FLASH_MAX_SIZE                  0x40000
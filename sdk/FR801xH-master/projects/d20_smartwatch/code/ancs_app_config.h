@@ -0,0 +1,31 @@
+/**
+ * Copyright (c) 2020, Freqchip
+ *
+ * All rights reserved.
+ *
+ *
+ */
+
+#ifndef _ANCS_APP_CONFIG_H
+#define _ANCS_APP_CONFIG_H
+
+/*
+ * MACROS
+ */
+
+/*
+ * Apps the watch tells apart, X(bundle id, icon, category, vibrate) each.
+ * Read by ANCS_app.h when ANCS_APP_CONFIG is defined, leave ANCS_APP_LIST
+ * undefined to use the list there.
+ */
+#define ANCS_APP_LIST(X) \
+    X("com.apple.mobilephone",  ANCS_APP_ICON_PHONE,    ANCS_APP_CAT_CALL,      ANCS_APP_VIBRATE_LONG) \
+    X("com.apple.MobileSMS",    ANCS_APP_ICON_SMS,      ANCS_APP_CAT_MESSAGE,   ANCS_APP_VIBRATE_DOUBLE) \
+    X("com.apple.mobilemail",   ANCS_APP_ICON_MAIL,     ANCS_APP_CAT_MAIL,      ANCS_APP_VIBRATE_SHORT) \
+    X("com.apple.mobilecal",    ANCS_APP_ICON_CALENDAR, ANCS_APP_CAT_SCHEDULE,  ANCS_APP_VIBRATE_DOUBLE) \
+    X("com.apple.reminders",    ANCS_APP_ICON_CALENDAR, ANCS_APP_CAT_SCHEDULE,  ANCS_APP_VIBRATE_SHORT) \
+    X("com.tencent.xin",        ANCS_APP_ICON_WEIXIN,   ANCS_APP_CAT_CHAT,      ANCS_APP_VIBRATE_SHORT) \
+    X("com.tencent.mqq",        ANCS_APP_ICON_QQ,       ANCS_APP_CAT_CHAT,      ANCS_APP_VIBRATE_SHORT) \
+    X("com.tencent.qq",         ANCS_APP_ICON_QQ,       ANCS_APP_CAT_CHAT,      ANCS_APP_VIBRATE_SHORT)
+
+#endif  // _ANCS_APP_CONFIG_H
@@ -6,9 +6,15 @@
 #define MAX_NEEDLES      30
 #define ANGLE_STEPS      24       // 360° / 15° increments
 #define SPIN_STEPS       1        // rotation steps per frame
-#define FRAME_DELAY_MS   45
 #define COLLISION_STEPS  1        // minimum angular separation
 
+// Power saving
+#define AMBIENT_MS       10000    // idle time before the ambient face
+#define PANEL_OFF_MS     60000    // idle time before the panel sleeps
+#define AMBIENT_TOP      44       // rows still driven in ambient
+#define AMBIENT_H        152
+#define IDLE_TICK_MS     1000     // frame period while the panel isn't active
+
 // Needle geometry offsets (outside circle)
 static const int8_t base_dx[ANGLE_STEPS] = {  64,  62,  56,  45,  33,  18,   4, -18,
                                              -33, -45, -56, -62, -64, -62, -56, -45,
@@ -30,13 +36,17 @@ typedef enum { STATE_PLAY, STATE_FLASH } game_state_t;
 // Global state
 static uint8_t      needles[MAX_NEEDLES];  // stored (unspun) angle indices
 static int          num_needles;
-static int          num_needles_cache;
 static uint8_t      spin_index;
 static bool         last_btn;
 static game_state_t state;
 static int          flash_count;
 static bool         flash_on;
 
+// Widgets
+static ui_widget_t *score;
+static ui_widget_t *dial;
+static ui_widget_t *ring;
+
 // Helpers
 static inline int wrap_idx(int i) {
     i %= ANGLE_STEPS;
@@ -63,30 +73,76 @@ static void draw_indicator(int cx, int cy) {
     gfx_draw_line(cx, y0, cx, y1, ST77XX_BLACK);
 }
 
-// Draw one needle, 3 px thick
+// Draw one needle, 3 px thick with anti-aliased edges
 static void draw_thick_needle(int cx, int cy, int idx, uint16_t color) {
     int bx = cx + base_dx[idx], by = cy + base_dy[idx];
     int tx = cx + tip_dx[idx],  ty = cy + tip_dy[idx];
-    // simple 3‑pixel thickness: draw the central line plus offsets ±1 in X and Y
-    for (int t = -1; t <= 1; t++) {
-        gfx_draw_line(bx + t, by,     tx + t, ty,     color);
-        gfx_draw_line(bx,     by + t, tx,     ty + t, color);
+    gfx_draw_thick_line_aa(bx, by, tx, ty, 3, color);
+}
+
+// Screen area a needle covers, with room for the line width and its edges
+static void invalidate_needle(int cx, int cy, int idx) {
+    int bx = cx + base_dx[idx], by = cy + base_dy[idx];
+    int tx = cx + tip_dx[idx],  ty = cy + tip_dy[idx];
+    int x0 = (bx < tx) ? bx : tx, y0 = (by < ty) ? by : ty;
+    ui_invalidate_rect(x0 - 3, y0 - 3, abs(tx - bx) + 7, abs(ty - by) + 7);
+}
+
+static void draw_dial(ui_widget_t *w, int16_t x, int16_t y, void *arg) {
+    int cx = x + w->w/2, cy = y + CIRCLE_RADIUS + 8;
+    gfx_fill_circle(cx, cy, CIRCLE_RADIUS, ST77XX_BLACK);
+    draw_indicator(cx, cy);
+}
+
+static void draw_needles(ui_widget_t *w, int16_t x, int16_t y, void *arg) {
+    int cx = x + w->w/2, cy = y + w->h/2;
+    for (int i = 0; i < num_needles; i++) {
+        draw_thick_needle(cx, cy, wrap_idx(needles[i] + spin_index), ST77XX_BLACK);
     }
 }
 
+static void show_score(void) {
+    char score_str[4];
+    sprintf(score_str, "%d", num_needles);
+    ui_set_text(score, score_str);
+}
+
+// Ambient face: just the circle and indicator, idle mode only shows 8 colors
+static void draw_ambient(void) {
+    ui_set_visible(ring, false);
+    ui_set_visible(score, false);
+    ui_render();
+}
+
+// Back from ambient with needles and score
+static void redraw(void) {
+    ui_set_visible(ring, true);
+    ui_set_visible(score, true);
+    ui_render();
+}
+
+static const display_pm_config_t pm_config = {
+    .ambient_ms    = AMBIENT_MS,
+    .off_ms        = PANEL_OFF_MS,
+    .ambient_top   = AMBIENT_TOP,
+    .ambient_h     = AMBIENT_H,
+    .enter_ambient = draw_ambient,
+    .wake          = redraw,
+};
+
 void app_init(void) {
-    gfx_init(DISPLAY_WIDTH, DISPLAY_HEIGHT, 2);
+    int cx = DISPLAY_WIDTH/2, cy = DISPLAY_HEIGHT/2;
+    int rr = tip_dx[0] + 2;
 
-    gfx_set_font(&FreeMono9pt7b);
-    gfx_set_text_color(ST77XX_BLACK);
-    gfx_set_text_size(1);
-    gfx_set_text_wrap(false);
-    gfx_set_cursor(5, 5);
+    gfx_init(DISPLAY_WIDTH, DISPLAY_HEIGHT, 2);
+    gfx_set_aa_bg(ST77XX_WHITE);
 
-    // Start with a clean white screen + big black circle + top indicator
-    gfx_fill_screen(ST77XX_WHITE);
-    gfx_fill_circle(DISPLAY_WIDTH/2, DISPLAY_HEIGHT/2, CIRCLE_RADIUS, ST77XX_BLACK);
-    draw_indicator(DISPLAY_WIDTH/2, DISPLAY_HEIGHT/2);
+    // White screen, big black circle with the top indicator, needles around it
+    ui_init(ST77XX_WHITE);
+    dial  = ui_canvas(NULL, cx - CIRCLE_RADIUS, cy - CIRCLE_RADIUS - 8,
+                      2*CIRCLE_RADIUS + 1, 2*CIRCLE_RADIUS + 9, draw_dial, NULL);
+    ring  = ui_canvas(NULL, cx - rr, cy - rr, 2*rr + 1, 2*rr + 1, draw_needles, NULL);
+    score = ui_label(NULL, 5, 5 + FreeMono9pt7b.yAdvance, &FreeMono9pt7b, ST77XX_BLACK);
 
     // Reset state
     num_needles = 0;
@@ -95,12 +151,31 @@ void app_init(void) {
     state       = STATE_PLAY;
     flash_count = 0;
     flash_on    = false;
+
+    show_score();
+    ui_render();
+
+    display_pm_init(&pm_config);
+    frame_sched_start(APP_FRAME_MS, app_update);
 }
 
-void app_update(void) {
+void app_update(uint32_t elapsed_ms) {
     int cx = DISPLAY_WIDTH/2, cy = DISPLAY_HEIGHT/2;
     bool btn = read_button_state();
 
+    if (btn) display_pm_activity();
+    display_pm_state_t was = display_pm_get_state();
+    if (display_pm_update(elapsed_ms) != DISPLAY_PM_ACTIVE) {
+        // Only the timeouts to run, the button triggers a frame itself
+        frame_sched_set_period(IDLE_TICK_MS);
+        return;
+    }
+    // The press that wakes the panel doesn't count as a move
+    if (was != DISPLAY_PM_ACTIVE) {
+        frame_sched_set_period(APP_FRAME_MS);
+        last_btn = btn;
+    }
+
     if (state == STATE_PLAY) {
         // 1) On button-press, queue up a new needle so that when drawn
         //    it lands at the *top* of the circle (world index = 18)
@@ -118,51 +193,39 @@ void app_update(void) {
         }
         last_btn = btn;
 
-        // 2) advance spinner
+        // 2) advance spinner, each needle is drawn again where it was and
+        //    where it goes
         uint8_t old_spin = spin_index;
         spin_index = wrap_idx(spin_index + SPIN_STEPS);
 
-        // Erase each needle at its old position
         for (int i = 0; i < num_needles; i++) {
-            int old_idx = wrap_idx(needles[i] + old_spin);
-            draw_thick_needle(cx, cy, old_idx, ST77XX_WHITE);
-        }
-        // Draw each needle at its new position
-        for (int i = 0; i < num_needles; i++) {
-            int new_idx = wrap_idx(needles[i] + spin_index);
-            draw_thick_needle(cx, cy, new_idx, ST77XX_BLACK);
+            invalidate_needle(cx, cy, wrap_idx(needles[i] + old_spin));
+            invalidate_needle(cx, cy, wrap_idx(needles[i] + spin_index));
         }
 
         // Display score in top-left
-        // Clear previous score area
-        if(num_needles != num_needles_cache) {
-            gfx_fill_rect(0, 0, 30, 30, ST77XX_WHITE);
-            
-            // Replace int_to_str with sprintf
-            char score_str[4];
-            sprintf(score_str, "%d", num_needles);
-            
-            gfx_set_cursor(5, 5);
-            gfx_print(score_str);
-            num_needles_cache = num_needles;
-        }
+        show_score();
 
     } else {
         // FLASH state (as before)
         flash_on = !flash_on;
-        gfx_fill_screen(flash_on ? ST77XX_RED : ST77XX_WHITE);
+        ui_set_visible(dial, false);
+        ui_set_visible(ring, false);
+        ui_set_visible(score, false);
+        ui_set_bg(ui_root(), flash_on ? ST77XX_RED : ST77XX_WHITE);
         flash_count++;
         if (flash_count >= 6) {
             // back to PLAY
-            gfx_fill_screen(ST77XX_WHITE);
-            gfx_fill_circle(cx, cy, CIRCLE_RADIUS, ST77XX_BLACK);
-            draw_indicator(cx, cy);
+            ui_set_visible(dial, true);
+            ui_set_visible(ring, true);
+            ui_set_visible(score, true);
             num_needles = 0;
             spin_index  = 0;
             last_btn    = false;
             state       = STATE_PLAY;
+            show_score();
         }
     }
 
-    delay_ms(FRAME_DELAY_MS);
+    ui_render();
 }
\ No newline at end of file
@@ -6,17 +6,23 @@
 #include "sys_utils.h"
 #include "display/display.h"
 #include "display/gfx.h"
+#include "display/display_pm.h"
+#include "ui/ui.h"
+#include "utils/frame_sched.h"
 #include "fonts/FreeMono9pt7b.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 
+// Frame period while the face is active
+#define APP_FRAME_MS 45
+
 #ifdef __cplusplus
 extern "C"
 {
 #endif
     void app_init();
-    void app_update();
+    void app_update(uint32_t elapsed_ms);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,261 @@
+#include "bench/gfx_bench.h"
+#include "fonts/FreeMono9pt7b.h"
+#include "fonts/FreeSans12pt7b.h"
+
+#define BENCH_BITMAP_SIZE 32
+
+typedef struct {
+    const char *name;
+    void (*run)(void);
+    gfx_render_mode_t mode;     // GFX_RENDER_DIRECT unless given
+    void (*setup)(void);        // Runs before the counters start, optional
+    void (*done)(void);         // Runs after they are read, optional
+} gfx_bench_case_t;
+
+static uint16_t _bitmap[BENCH_BITMAP_SIZE * BENCH_BITMAP_SIZE];
+static uint8_t _mask[BENCH_BITMAP_SIZE * BENCH_BITMAP_SIZE / 8];
+static uint8_t _image_data[BENCH_BITMAP_SIZE * 9];    // Three 3 byte runs per row
+static gfx_image_t _image;
+static int16_t _hexagon[] = { 120, 40, 190, 80, 190, 160, 120, 200, 50, 160, 50, 80 };
+static int16_t _star[] = { 120, 20, 140, 95, 220, 95, 155, 140, 180, 220, 120, 170, 60, 220, 85, 140, 20, 95, 100, 95 };
+
+static void _line_short(void)      { gfx_draw_line(10, 10, 30, 17, ST77XX_WHITE); }
+static void _line_diagonal(void)   { gfx_draw_line(0, 0, 239, 239, ST77XX_WHITE); }
+static void _line_shallow(void)    { gfx_draw_line(0, 100, 239, 140, ST77XX_WHITE); }
+static void _line_h(void)          { gfx_draw_fast_h_line(20, 120, 200, ST77XX_WHITE); }
+static void _line_v(void)          { gfx_draw_fast_v_line(120, 20, 200, ST77XX_WHITE); }
+static void _line_dashed(void)     { gfx_draw_dashed_line(0, 0, 239, 239, ST77XX_WHITE, 6, 4); }
+static void _rect(void)            { gfx_draw_rect(70, 90, 100, 60, ST77XX_WHITE); }
+static void _rect_fill(void)       { gfx_fill_rect(70, 90, 100, 60, ST77XX_WHITE); }
+static void _rect_round(void)      { gfx_draw_round_rect(70, 90, 100, 60, 12, ST77XX_WHITE); }
+static void _rect_round_fill(void) { gfx_fill_round_rect(70, 90, 100, 60, 12, ST77XX_WHITE); }
+static void _screen_fill(void)     { gfx_fill_screen(ST77XX_BLACK); }
+static void _circle_10(void)       { gfx_draw_circle(120, 120, 10, ST77XX_WHITE); }
+static void _circle_100(void)      { gfx_draw_circle(120, 120, 100, ST77XX_WHITE); }
+static void _circle_fill_10(void)  { gfx_fill_circle(120, 120, 10, ST77XX_WHITE); }
+static void _circle_fill_100(void) { gfx_fill_circle(120, 120, 100, ST77XX_WHITE); }
+static void _arc_thin(void)        { gfx_draw_arc(120, 120, 100, 0, 270, 1, ST77XX_WHITE); }
+static void _arc_thick(void)       { gfx_draw_arc(120, 120, 100, 0, 270, 8, ST77XX_WHITE); }
+static void _line_aa(void)         { gfx_draw_line_aa(10, 30, 230, 200, ST77XX_WHITE); }
+static void _thick_line_aa(void)   { gfx_draw_thick_line_aa(120, 120, 180, 40, 3, ST77XX_WHITE); }
+static void _circle_aa_100(void)   { gfx_draw_circle_aa(120, 120, 100, ST77XX_WHITE); }
+static void _circle_fill_aa_100(void) { gfx_fill_circle_aa(120, 120, 100, ST77XX_WHITE); }
+static void _arc_aa_270_t8(void)   { gfx_draw_arc_aa(120, 120, 100, 0, 270, 8, ST77XX_WHITE); }
+static void _ellipse(void)         { gfx_draw_ellipse(120, 120, 100, 50, ST77XX_WHITE); }
+static void _ellipse_fill(void)    { gfx_fill_ellipse(120, 120, 100, 50, ST77XX_WHITE); }
+static void _triangle(void)        { gfx_draw_triangle(120, 20, 220, 200, 20, 200, ST77XX_WHITE); }
+static void _triangle_fill(void)   { gfx_fill_triangle(120, 20, 220, 200, 20, 200, ST77XX_WHITE); }
+static void _polygon(void)         { gfx_draw_polygon(_star, 10, ST77XX_WHITE); }
+static void _polygon_fill_6(void)  { gfx_fill_polygon(_hexagon, 6, ST77XX_WHITE); }
+static void _polygon_fill_10(void) { gfx_fill_polygon(_star, 10, ST77XX_WHITE); }
+
+static void _text(const GFXfont *font, uint8_t size, bool opaque) {
+    gfx_set_font(font);
+    gfx_set_text_size(size);
+    gfx_set_text_wrap(false);
+    if (opaque) {
+        gfx_set_text_color_bg(ST77XX_WHITE, ST77XX_BLACK);
+    } else {
+        gfx_set_text_color(ST77XX_WHITE);
+    }
+    gfx_set_cursor(0, 60);
+    gfx_print("12:34");
+}
+
+static void _text_mono_1(void)        { _text(&FreeMono9pt7b, 1, false); }
+static void _text_mono_2(void)        { _text(&FreeMono9pt7b, 2, false); }
+static void _text_mono_3(void)        { _text(&FreeMono9pt7b, 3, false); }
+static void _text_sans_1(void)        { _text(&FreeSans12pt7b, 1, false); }
+static void _text_sans_2(void)        { _text(&FreeSans12pt7b, 2, false); }
+static void _text_sans_3(void)        { _text(&FreeSans12pt7b, 3, false); }
+static void _text_sans_1_opaque(void) { _text(&FreeSans12pt7b, 1, true); }
+static void _text_sans_3_opaque(void) { _text(&FreeSans12pt7b, 3, true); }
+
+static void _bitmap_1bit(void)   { gfx_draw_bitmap(100, 100, _mask, BENCH_BITMAP_SIZE, BENCH_BITMAP_SIZE, ST77XX_WHITE); }
+static void _bitmap_1bit_bg(void) {
+    gfx_draw_bitmap_bg(100, 100, _mask, BENCH_BITMAP_SIZE, BENCH_BITMAP_SIZE, ST77XX_WHITE, ST77XX_BLACK);
+}
+static void _bitmap_scaled(void) { gfx_draw_scaled_bitmap(40, 40, _mask, BENCH_BITMAP_SIZE, BENCH_BITMAP_SIZE, 4, ST77XX_WHITE); }
+static void _bitmap_rgb(void)    { gfx_draw_rgb_bitmap(100, 100, _bitmap, BENCH_BITMAP_SIZE, BENCH_BITMAP_SIZE); }
+static void _bitmap_rgb_mask(void) {
+    gfx_draw_rgb_bitmap_with_mask(100, 100, _bitmap, _mask, BENCH_BITMAP_SIZE, BENCH_BITMAP_SIZE);
+}
+static void _image_rle(void)     { gfx_draw_image(100, 100, &_image); }
+
+// A small watch face, drawn as one scene
+static void _scene_draw(void) {
+    gfx_fill_circle(120, 120, 100, ST77XX_BLUE);
+    gfx_draw_arc(120, 120, 110, 0, 200, 6, ST77XX_ORANGE);
+    gfx_draw_line(120, 120, 170, 60, ST77XX_WHITE);
+    gfx_draw_line(120, 120, 80, 170, ST77XX_WHITE);
+    gfx_draw_rgb_bitmap(104, 180, _bitmap, BENCH_BITMAP_SIZE, BENCH_BITMAP_SIZE);
+    _text(&FreeSans12pt7b, 2, false);
+}
+
+static void _scene_direct(void) {
+    gfx_fill_screen(ST77XX_BLACK);
+    _scene_draw();
+}
+
+static void _scene_band(void) {
+    gfx_band_begin(ST77XX_BLACK);
+    do {
+        _scene_draw();
+    } while (gfx_band_next());
+}
+
+static void _scene_frame(void) {
+    gfx_begin_frame(ST77XX_BLACK);
+    _scene_draw();
+    gfx_end_frame();
+}
+
+// A notification list of 30 row entries, moved one finger flick (8 rows)
+#define BENCH_LIST_ROW 30
+
+static void _list_draw(int16_t y, int16_t h, int16_t dy, void *arg) {
+    char label[8] = "item ";
+
+    for (int16_t i = y / BENCH_LIST_ROW; i * BENCH_LIST_ROW < y + h; i++) {
+        int16_t row = i * BENCH_LIST_ROW + dy;
+        label[5] = '0' + (i / 10) % 10;
+        label[6] = '0' + i % 10;
+        gfx_fill_rect(0, row, DISPLAY_WIDTH, BENCH_LIST_ROW - 1, (i & 1) ? ST77XX_BLACK : 0x2104);
+        gfx_draw_fast_h_line(0, row + BENCH_LIST_ROW - 1, DISPLAY_WIDTH, 0x8410);
+        gfx_draw_text(10, row + 21, label, ST77XX_WHITE);
+    }
+}
+
+static void _list_open(void) {
+    gfx_set_font(&FreeSans12pt7b);
+    gfx_set_text_size(1);
+    gfx_scroll_view_begin(0, DISPLAY_HEIGHT, ST77XX_BLACK, _list_draw, NULL);
+}
+
+static void _list_step(void) { gfx_scroll_by(8); }
+
+static void _list_repaint(void) {
+    gfx_set_font(&FreeSans12pt7b);
+    gfx_set_text_size(1);
+    gfx_band_begin(ST77XX_BLACK);
+    do {
+        _list_draw(8, DISPLAY_HEIGHT, -8, NULL);
+    } while (gfx_band_next());
+}
+
+static void _rgb444_on(void)  { display_set_color_mode(DISPLAY_COLOR_444); }
+static void _rgb444_off(void) { display_set_color_mode(DISPLAY_COLOR_565); }
+
+static const gfx_bench_case_t _cases[] = {
+    { "line_short",          _line_short },
+    { "line_diagonal",       _line_diagonal },
+    { "line_shallow",        _line_shallow },
+    { "line_h_200",          _line_h },
+    { "line_v_200",          _line_v },
+    { "line_dashed",         _line_dashed },
+    { "rect_100x60",         _rect },
+    { "rect_fill_100x60",    _rect_fill },
+    { "round_rect",          _rect_round },
+    { "round_rect_fill",     _rect_round_fill },
+    { "screen_fill",         _screen_fill },
+    { "circle_r10",          _circle_10 },
+    { "circle_r100",         _circle_100 },
+    { "circle_fill_r10",     _circle_fill_10 },
+    { "circle_fill_r100",    _circle_fill_100 },
+    { "arc_270_t1",          _arc_thin },
+    { "arc_270_t8",          _arc_thick },
+    { "line_aa",             _line_aa },
+    { "thick_line_aa_w3",    _thick_line_aa },
+    { "circle_aa_r100",      _circle_aa_100 },
+    { "circle_fill_aa_r100", _circle_fill_aa_100 },
+    { "arc_aa_270_t8",       _arc_aa_270_t8 },
+    { "ellipse",             _ellipse },
+    { "ellipse_fill",        _ellipse_fill },
+    { "triangle",            _triangle },
+    { "triangle_fill",       _triangle_fill },
+    { "polygon_10",          _polygon },
+    { "polygon_fill_6",      _polygon_fill_6 },
+    { "polygon_fill_10",     _polygon_fill_10 },
+    { "text_mono_1",         _text_mono_1 },
+    { "text_mono_2",         _text_mono_2 },
+    { "text_mono_3",         _text_mono_3 },
+    { "text_sans_1",         _text_sans_1 },
+    { "text_sans_2",         _text_sans_2 },
+    { "text_sans_3",         _text_sans_3 },
+    { "text_sans_1_opaque",  _text_sans_1_opaque },
+    { "text_sans_3_opaque",  _text_sans_3_opaque },
+    { "bitmap_1bit",         _bitmap_1bit },
+    { "bitmap_1bit_bg",      _bitmap_1bit_bg },
+    { "bitmap_scaled_x4",    _bitmap_scaled },
+    { "bitmap_rgb",          _bitmap_rgb },
+    { "bitmap_rgb_mask",     _bitmap_rgb_mask },
+    { "image_rle",           _image_rle },
+    { "scene_direct",        _scene_direct },
+    { "scene_band",          _scene_band, GFX_RENDER_BAND },
+    { "scene_frame",         _scene_frame },
+    { "list_repaint",        _list_repaint, GFX_RENDER_BAND },
+    { "list_scroll_8",       _list_step, GFX_RENDER_DIRECT, _list_open, gfx_scroll_view_end },
+    { "screen_fill_444",     _screen_fill, GFX_RENDER_DIRECT, _rgb444_on, _rgb444_off },
+    { "bitmap_rgb_444",      _bitmap_rgb, GFX_RENDER_DIRECT, _rgb444_on, _rgb444_off },
+    { "scene_band_444",      _scene_band, GFX_RENDER_BAND, _rgb444_on, _rgb444_off },
+};
+
+// Test data, a color gradient with a round mask and the same size RLE image
+static void _bench_data_init(void) {
+    int16_t c = BENCH_BITMAP_SIZE / 2;
+
+    memset(_mask, 0, sizeof(_mask));
+    for (int16_t y = 0; y < BENCH_BITMAP_SIZE; y++) {
+        for (int16_t x = 0; x < BENCH_BITMAP_SIZE; x++) {
+            _bitmap[y * BENCH_BITMAP_SIZE + x] = display_get_color(x * 8, y * 8, 128);
+            if ((x - c) * (x - c) + (y - c) * (y - c) < c * c) {
+                _mask[(y * BENCH_BITMAP_SIZE + x) / 8] |= 1 << (x & 7);
+            }
+        }
+    }
+
+    // Every row is a red run, a green run and a blue run
+    uint8_t *p = _image_data;
+    for (uint8_t i = 0; i < 3; i++) {
+        uint16_t color = (i == 0) ? 0xF800 : (i == 1) ? 0x07E0 : 0x001F;
+        uint8_t len = (i == 2) ? BENCH_BITMAP_SIZE - 2 * (BENCH_BITMAP_SIZE / 3) : BENCH_BITMAP_SIZE / 3;
+        *p++ = 0x80 | (len - 1);
+        *p++ = color >> 8;
+        *p++ = color & 0xFF;
+    }
+    for (uint8_t y = 1; y < BENCH_BITMAP_SIZE; y++) {
+        memcpy(&_image_data[y * 9], _image_data, 9);
+    }
+    _image.data = _image_data;
+    _image.palette = NULL;
+    _image.width = BENCH_BITMAP_SIZE;
+    _image.height = BENCH_BITMAP_SIZE;
+    _image.format = GFX_IMAGE_RLE565;
+}
+
+void gfx_bench_run(void) {
+    display_stats_t stats;
+
+    _bench_data_init();
+    gfx_init(DISPLAY_WIDTH, DISPLAY_HEIGHT, 2);
+
+    co_printf("case,pixels,bytes,windows,selects,us\r\n");
+    for (uint8_t i = 0; i < sizeof(_cases) / sizeof(_cases[0]); i++) {
+        if (_cases[i].mode != gfx_get_render_mode()) {
+            gfx_init_mode(DISPLAY_WIDTH, DISPLAY_HEIGHT, 2, _cases[i].mode);
+        }
+        gfx_fill_screen(ST77XX_BLACK);
+        if (_cases[i].setup) _cases[i].setup();
+        display_wait_idle();
+        display_reset_stats();
+
+        _cases[i].run();
+        display_wait_idle();
+
+        display_get_stats(&stats);
+        co_printf("%s,%u,%u,%u,%u,%u\r\n", _cases[i].name, (unsigned)stats.pixels, (unsigned)stats.bytes,
+                  (unsigned)stats.windows, (unsigned)stats.selects,
+                  (unsigned)((uint64_t)stats.bytes * 8 * 1000000 / DISPLAY_SPI_HZ));
+        if (_cases[i].done) _cases[i].done();
+    }
+}
@@ -0,0 +1,17 @@
+#ifndef GFX_BENCH_H
+#define GFX_BENCH_H
+
+#include "display/display.h"
+#include "display/gfx.h"
+
+// Set to 1 to run the benchmark once at boot, results go to UART1
+#ifndef GFX_BENCH
+#define GFX_BENCH 0
+#endif
+
+// Draws every primitive over a few representative sizes and prints one CSV
+// line per case with co_printf: pixels, SPI bytes, address windows and the
+// transfer time those bytes take at DISPLAY_SPI_HZ. Leaves the screen dirty.
+void gfx_bench_run(void);
+
+#endif // GFX_BENCH_H
@@ -1,4 +1,8 @@
 #include "display/display.h"
+#include "driver_system.h"
+#include <string.h>
+
+#define SLPOUT_TO_SLPIN_MS 120
 
 static uint16_t _width;       // Display width
 static uint16_t _height;      // Display height
@@ -10,33 +14,90 @@ static uint8_t _rowstart;     // Row offset
 static uint8_t _colstart2;    // Column offset for rotation
 static uint8_t _rowstart2;    // Row offset for rotation
 
+// Vertical scroll area in panel lines, which run bottom to top in rotation 0
+static uint16_t _scroll_tfa;
+static uint16_t _scroll_h;
+static bool _scroll_flip;
+
+static uint32_t _slpout_ms;     // When SLPOUT was last sent
+
+// Bus state. Writes queue up under one CS assertion until bus_release, and DC
+// only changes once the FIFO has drained.
+static bool _selected;
+static uint8_t _dc_level = 0xFF;    // Unknown until first set
+
+// CASET and RASET as last sent in panel coordinates, the panel keeps them
+// across RAMWR and rotation changes
+static uint16_t _win[4];
+static bool _win_valid;
+
+// Asynchronous transfer queue, _xfer_queue[_xfer_head] is the one on the wire
+typedef struct {
+    uint8_t x0, y0, x1, y1;
+    const uint8_t *data;
+    uint32_t length;            // Bytes
+    display_xfer_cb_t done;
+    void *arg;
+} display_xfer_t;
+
+static display_xfer_t _xfer_queue[DISPLAY_XFER_QUEUE_LEN];
+static volatile uint8_t _xfer_head;
+static volatile uint8_t _xfer_count;
+static const uint8_t *_xfer_data;   // Next byte of the active window
+static uint32_t _xfer_left;         // Bytes of the active window not yet in the FIFO
+static bool _xfer_async = true;
+
+// One row of _line_color shared by all solid fills, DISPLAY_WIDTH * 2 is a multiple of 120
+static uint16_t _line_buf[DISPLAY_WIDTH];
+static uint16_t _line_color;
+static bool _line_valid = false;
+
+// 12 bit pixels, packed through _pack_buf on the way out
+static bool _rgb444;
+static uint8_t _pack_buf[120];
+
+#if DISPLAY_STATS
+static display_stats_t _stats;
+#define STATS_ADD(field, n) (_stats.field += (n))
+#else
+#define STATS_ADD(field, n) ((void)0)
+#endif
+
 static void write_command(uint8_t cmd);
 static void write_data(uint8_t data);
 static void write_data16(uint16_t data);
 static void set_dc_pin(uint8_t value);
 static void set_reset_pin(uint8_t value);
 static void cs_control(uint8_t op);
+static void bus_dc(uint8_t value);
+static void bus_release(void);
+static void set_addr_window(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1);
+static void xfer_start(const display_xfer_t *xfer);
+static void xfer_service(void);
+static void bus_init(void);
+static uint32_t pack444(uint8_t *dst, const uint8_t *src, uint32_t pixels);
+static uint32_t window_bytes(uint32_t pixels);
 
 // Helper functions implementation
 static void write_command(uint8_t cmd) {
-    set_dc_pin(0);  // Command mode
+    STATS_ADD(commands, 1);
+    STATS_ADD(bytes, 1);
     cs_control(SSP_CS_ENABLE);
+    bus_dc(0);  // Command mode
     ssp_send_byte(cmd);
-    ssp_wait_send_end();
-    cs_control(SSP_CS_DISABLE);
 }
 
 static void write_data(uint8_t data) {
-    set_dc_pin(1);  // Data mode
+    STATS_ADD(bytes, 1);
     cs_control(SSP_CS_ENABLE);
+    bus_dc(1);  // Data mode
     ssp_send_byte(data);
-    ssp_wait_send_end();
-    cs_control(SSP_CS_DISABLE);
 }
 
 static void write_data16(uint16_t data) {
-    set_dc_pin(1);  // Data mode
+    STATS_ADD(bytes, 2);
     cs_control(SSP_CS_ENABLE);
+    bus_dc(1);  // Data mode
     
     // Send data in big-endian format (MSB first)
     uint8_t data_bytes[2] = {
@@ -45,12 +106,11 @@ static void write_data16(uint16_t data) {
     };
     
     ssp_send_bytes(data_bytes, 2);
-    ssp_wait_send_end();
-    cs_control(SSP_CS_DISABLE);
 }
 
 static void set_dc_pin(uint8_t value) {
     gpio_set_pin_value(DISPLAY_DC_PIN_NAME, DISPLAY_DC_PIN_NUM, value);
+    _dc_level = value;
 }
 
 static void set_reset_pin(uint8_t value) {
@@ -58,10 +118,95 @@ static void set_reset_pin(uint8_t value) {
 }
 
 static void cs_control(uint8_t op) {
+    if ((op == SSP_CS_ENABLE) == _selected) return;
+    if (op == SSP_CS_ENABLE) STATS_ADD(selects, 1);
+    _selected = (op == SSP_CS_ENABLE);
+
     // Invert the logic - CS is typically active low
     gpio_set_pin_value(DISPLAY_CS_PIN_NAME, DISPLAY_CS_PIN_NUM, op == SSP_CS_ENABLE ? 0 : 1);
 }
 
+// The panel samples DC with the last bit of each byte, so bytes already in
+// the FIFO have to go out first
+static void bus_dc(uint8_t value) {
+    if (value == _dc_level) return;
+    ssp_wait_send_end();
+    set_dc_pin(value);
+}
+
+// End of a batch, wait for the FIFO and deselect
+static void bus_release(void) {
+    if (!_selected) return;
+    ssp_wait_send_end();
+    cs_control(SSP_CS_DISABLE);
+}
+
+// Pins and SSP, again after system sleep since peripherals lose their state
+static void bus_init(void) {
+    system_set_port_mux(DISPLAY_SCL_PIN_NAME, DISPLAY_SCL_PIN_NUM, DISPLAY_SCL_PIN_FUNC);
+    system_set_port_mux(DISPLAY_SDA_PIN_NAME, DISPLAY_SDA_PIN_NUM, DISPLAY_SDA_PIN_FUNC);
+    
+    // Initialize SPI with 8-bit frame width, Motorola frame type, master mode
+    ssp_init_(8, SSP_FRAME_MOTO, SSP_MASTER_MODE, DISPLAY_SPI_HZ, 2, cs_control);
+    NVIC_EnableIRQ(SSP_IRQn);
+
+    // CS
+    system_set_port_mux(DISPLAY_CS_PIN_NAME, DISPLAY_CS_PIN_NUM, DISPLAY_CS_PIN_FUNC);
+    gpio_set_dir(DISPLAY_CS_PIN_NAME, DISPLAY_CS_PIN_NUM, GPIO_DIR_OUT);
+
+    // DC
+    system_set_port_mux(DISPLAY_DC_PIN_NAME, DISPLAY_DC_PIN_NUM, DISPLAY_DC_PIN_FUNC);
+    gpio_set_dir(DISPLAY_DC_PIN_NAME, DISPLAY_DC_PIN_NUM, GPIO_DIR_OUT);
+
+    // Reset
+    system_set_port_mux(DISPLAY_RESET_PIN_NAME, DISPLAY_RESET_PIN_NUM, DISPLAY_RESET_PIN_FUNC);
+    gpio_set_dir(DISPLAY_RESET_PIN_NAME, DISPLAY_RESET_PIN_NUM, GPIO_DIR_OUT);
+
+    // Deselected, whatever the pins did before
+    gpio_set_pin_value(DISPLAY_CS_PIN_NAME, DISPLAY_CS_PIN_NUM, 1);
+    _selected = false;
+    set_dc_pin(1);
+}
+
+// Pack big endian RGB565 pixels to RGB444, an odd last pixel takes 2 bytes.
+// Returns the bytes written.
+__attribute__((section("ram_code"))) static uint32_t pack444(uint8_t *dst, const uint8_t *src, uint32_t pixels) {
+    uint8_t *p = dst;
+
+    for (; pixels >= 2; pixels -= 2, src += 4) {
+        uint16_t a = DISPLAY_RGB444((src[0] << 8) | src[1]);
+        uint16_t b = DISPLAY_RGB444((src[2] << 8) | src[3]);
+        *p++ = a >> 4;
+        *p++ = (a << 4) | (b >> 8);
+        *p++ = b;
+    }
+    if (pixels) {
+        uint16_t a = DISPLAY_RGB444((src[0] << 8) | src[1]);
+        *p++ = a >> 4;
+        *p++ = a << 4;
+    }
+    return p - dst;
+}
+
+// Bytes on the bus for a window of pixels
+static uint32_t window_bytes(uint32_t pixels) {
+    return _rgb444 ? pixels / 2 * 3 + (pixels & 1) * 2 : pixels * 2;
+}
+
+// Hold a pin at value from the always on domain while the system sleeps
+static void pin_to_pmu(enum system_port_t port, enum system_port_bit_t bit, uint8_t value) {
+    pmu_set_port_mux(port, bit, PMU_PORT_MUX_GPIO);
+    pmu_set_pin_dir(port, 1 << bit, GPIO_DIR_OUT);
+    pmu_set_gpio_value(port, 1 << bit, value);
+    pmu_set_pin_to_PMU(port, 1 << bit);
+}
+
+// First panel line of screen rows [top, top + h), panel lines run bottom to
+// top in rotation 0
+static uint16_t panel_line(uint16_t top, uint16_t h) {
+    return (_rotation == 0) ? 320 - (_ystart + top + h) : _ystart + top;
+}
+
 // Public functions
 
 void display_init(uint16_t width, uint16_t height, uint8_t rotation) {
@@ -85,23 +230,7 @@ void display_init(uint16_t width, uint16_t height, uint8_t rotation) {
         _colstart = _colstart2 = (int)((240 - width) / 2);
     }
 
-    system_set_port_mux(DISPLAY_SCL_PIN_NAME, DISPLAY_SCL_PIN_NUM, DISPLAY_SCL_PIN_FUNC);
-    system_set_port_mux(DISPLAY_SDA_PIN_NAME, DISPLAY_SDA_PIN_NUM, DISPLAY_SDA_PIN_FUNC);
-    
-    // Initialize SPI with 8-bit frame width, Motorola frame type, master mode
-    ssp_init_(8, SSP_FRAME_MOTO, SSP_MASTER_MODE, 24000000, 2, cs_control);
-
-    // CS
-    system_set_port_mux(DISPLAY_CS_PIN_NAME, DISPLAY_CS_PIN_NUM, DISPLAY_CS_PIN_FUNC);
-    gpio_set_dir(DISPLAY_CS_PIN_NAME, DISPLAY_CS_PIN_NUM, GPIO_DIR_OUT);
-
-    // DC
-    system_set_port_mux(DISPLAY_DC_PIN_NAME, DISPLAY_DC_PIN_NUM, DISPLAY_DC_PIN_FUNC);
-    gpio_set_dir(DISPLAY_DC_PIN_NAME, DISPLAY_DC_PIN_NUM, GPIO_DIR_OUT);
-
-    // Reset
-    system_set_port_mux(DISPLAY_RESET_PIN_NAME, DISPLAY_RESET_PIN_NUM, DISPLAY_RESET_PIN_FUNC);
-    gpio_set_dir(DISPLAY_RESET_PIN_NAME, DISPLAY_RESET_PIN_NUM, GPIO_DIR_OUT);
+    bus_init();
     
     // Hardware reset the display
     set_reset_pin(1);
@@ -113,15 +242,18 @@ void display_init(uint16_t width, uint16_t height, uint8_t rotation) {
         
     // Software Reset
     write_command(ST77XX_SWRESET);
+    bus_release();
     delay_ms(15);
+    _scroll_h = 0;
+    _win_valid = false;
     
     // Sleep Out
     write_command(ST77XX_SLPOUT);
+    _slpout_ms = system_get_curr_time();
     delay_ms(10);
     
-    // Set Color Mode to 16-bit
-    write_command(ST77XX_COLMOD);
-    write_data(0x55);  // 16-bit color
+    // Color mode, 16 or 12 bit
+    display_set_color_mode(DISPLAY_COLOR_MODE);
     delay_ms(10);
     
     // Memory Access Control (directions)
@@ -152,6 +284,7 @@ void display_init(uint16_t width, uint16_t height, uint8_t rotation) {
     
     // Display On
     write_command(ST77XX_DISPON);
+    bus_release();
     delay_ms(10);
     
     display_set_rotation(rotation);
@@ -160,42 +293,71 @@ void display_init(uint16_t width, uint16_t height, uint8_t rotation) {
 }
 
 void display_set_addr_window(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1) {
-    // Account for screen rotation and offsets
-    x0 += _xstart;
-    y0 += _ystart;
-    x1 += _xstart;
-    y1 += _ystart;
+    display_wait_idle();
+    set_addr_window(x0, y0, x1, y1);
+    bus_release();
+}
+
+// Leaves the panel selected with DC high, ready for pixels
+static void set_addr_window(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1) {
+    STATS_ADD(windows, 1);
     
-    // Set column address
-    write_command(ST77XX_CASET);
-    write_data16(x0);
-    write_data16(x1);
+    // Set column address, accounting for screen rotation and offsets. The
+    // offset can push rows past 255 in rotation 0. Either one is skipped when
+    // the panel already has it.
+    uint16_t win[4] = { x0 + _xstart, x1 + _xstart, y0 + _ystart, y1 + _ystart };
+    if (!_win_valid || win[0] != _win[0] || win[1] != _win[1]) {
+        write_command(ST77XX_CASET);
+        write_data16(win[0]);
+        write_data16(win[1]);
+    }
     
     // Set row address
-    write_command(ST77XX_RASET);
-    write_data16(y0);
-    write_data16(y1);
+    if (!_win_valid || win[2] != _win[2] || win[3] != _win[3]) {
+        write_command(ST77XX_RASET);
+        write_data16(win[2]);
+        write_data16(win[3]);
+    }
+    memcpy(_win, win, sizeof(_win));
+    _win_valid = true;
     
     // Prepare to write to display RAM
     write_command(ST77XX_RAMWR);
+    bus_dc(1);
 }
 
 void display_fill_window(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, uint16_t* color_buffer, uint32_t size) {
-    // Set address window
-    display_set_addr_window(x0, y0, x1, y1);
-    
-    // Write color data
-    set_dc_pin(1);  // Data mode
-    cs_control(SSP_CS_ENABLE);
+    display_wait_idle();
+
+    // Set address window, the color data follows under the same CS
+    set_addr_window(x0, y0, x1, y1);
     
     // Calculate number of pixels to fill
     uint32_t pixel_count = (x1 - x0 + 1) * (y1 - y0 + 1);
     uint32_t bytes_to_send = pixel_count * 2;  // 2 bytes per pixel
+    STATS_ADD(pixels, pixel_count);
+    STATS_ADD(bytes, window_bytes(pixel_count));
     
     // Send data in chunks if needed
     uint32_t chunk_size = 120;  // SSP can send 120 bytes at once efficiently
     uint8_t* bytes = (uint8_t*)color_buffer;
     
+    if (_rgb444) {
+        // 80 pixels pack into 120 bytes
+        for (uint32_t i = 0; i < pixel_count; i += 80) {
+            uint32_t n = pack444(_pack_buf, &bytes[i * 2], (pixel_count - i < 80) ? pixel_count - i : 80);
+
+            if (n == 120) {
+                ssp_send_120Bytes(_pack_buf);
+            } else {
+                ssp_send_bytes(_pack_buf, n);
+            }
+            ssp_wait_send_end();
+        }
+        bus_release();
+        return;
+    }
+
     for (uint32_t i = 0; i < bytes_to_send; i += chunk_size) {
         uint32_t current_chunk = (bytes_to_send - i < chunk_size) ? (bytes_to_send - i) : chunk_size;
         
@@ -207,59 +369,67 @@ void display_fill_window(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, uint16_
         ssp_wait_send_end();
     }
     
-    cs_control(SSP_CS_DISABLE);
+    bus_release();
 }
 
 void display_fill_screen(uint16_t color) {
-    // Create a buffer for one row of pixels
-    uint16_t buffer[_width]; // Max width is 240
+    display_fill_window_color(0, 0, _width - 1, _height - 1, color);
+}
+
+void display_fill_window_color(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, uint16_t color) {
+    display_wait_idle();
 
-    // Fill the buffer with the specified color
-    for (int i = 0; i < _width; i++) {
-        buffer[i] = color;
+    // Replicate the color across the shared row buffer (panel byte order).
+    // Packed 12 bit pixels repeat every 3 bytes, which divides 120 as well.
+    if (color != _line_color || !_line_valid) {
+        if (_rgb444) {
+            uint16_t c = DISPLAY_RGB444(color);
+            uint8_t *p = (uint8_t *)_line_buf;
+            for (uint32_t i = 0; i < sizeof(_line_buf); i += 3) {
+                p[i] = c >> 4;
+                p[i + 1] = (c << 4) | (c >> 8);
+                p[i + 2] = c;
+            }
+        } else {
+            for (int i = 0; i < DISPLAY_WIDTH; i++) {
+                _line_buf[i] = DISPLAY_SWAP16(color);
+            }
+        }
+        _line_color = color;
+        _line_valid = true;
     }
     
-    // Set address window to entire screen (including offsets)
-    display_set_addr_window(0, 0, _width - 1, _height - 1);
-    
-    // Fill screen row by row
-    set_dc_pin(1);  // Data mode
-    cs_control(SSP_CS_ENABLE);
+    set_addr_window(x0, y0, x1, y1);
     
-    // Calculate total number of pixels
-    uint32_t total_pixels = _width * _height;
-    uint32_t pixels_sent = 0;
+    // Stream the row buffer until the window is full
+    uint32_t pixel_count = (uint32_t)(x1 - x0 + 1) * (y1 - y0 + 1);
+    uint32_t bytes_remaining = window_bytes(pixel_count);
+    uint32_t buffer_offset = 0;
+    STATS_ADD(pixels, pixel_count);
+    STATS_ADD(bytes, bytes_remaining);
     
-    // Send pixels in chunks
-    while (pixels_sent < total_pixels) {
-        uint32_t line_pixels = (_width < (total_pixels - pixels_sent)) ? _width : (total_pixels - pixels_sent);
-        uint32_t pixels_remaining = line_pixels;
-        uint32_t buffer_offset = 0;
+    while (bytes_remaining > 0) {
+        // SSP can efficiently send 120 bytes at once, 4 of those make up the buffer
+        uint32_t bytes_to_send = (bytes_remaining > 120) ? 120 : bytes_remaining;
+        const uint8_t *bytes = (const uint8_t *)_line_buf + buffer_offset;
         
-        while (pixels_remaining > 0) {
-            // Determine chunk size - SSP can efficiently send 120 bytes at once
-            // 120 bytes = 60 pixels (since each pixel is 2 bytes)
-            uint32_t pixels_to_send = (pixels_remaining > 60) ? 60 : pixels_remaining;
-            uint32_t bytes_to_send = pixels_to_send * 2;
-            
-            if (bytes_to_send == 120) {
-                ssp_send_120Bytes((const uint8_t*)&buffer[buffer_offset]);
-            } else {
-                ssp_send_bytes((const uint8_t*)&buffer[buffer_offset], bytes_to_send);
-            }
-            ssp_wait_send_end();
-            
-            buffer_offset += pixels_to_send;
-            pixels_remaining -= pixels_to_send;
+        if (bytes_to_send == 120) {
+            ssp_send_120Bytes(bytes);
+        } else {
+            ssp_send_bytes(bytes, bytes_to_send);
         }
+        ssp_wait_send_end();
         
-        pixels_sent += line_pixels;
+        buffer_offset = (buffer_offset + 120) % sizeof(_line_buf);
+        bytes_remaining -= bytes_to_send;
     }
     
-    cs_control(SSP_CS_DISABLE);
+    bus_release();
 }
 
 void display_set_rotation(uint8_t m) {
+    display_wait_idle();
+
     uint8_t madctl = 0;
     
     _rotation = m & 3;  // can't be higher than 3
@@ -289,26 +459,265 @@ void display_set_rotation(uint8_t m) {
     
     write_command(ST77XX_MADCTL);
     write_data(madctl);
+    bus_release();
 }
 
 uint16_t display_get_color(uint8_t r, uint8_t g, uint8_t b) {
     return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
 }
 
+void display_set_color_mode(display_color_mode_t mode) {
+    display_wait_idle();
+
+    _rgb444 = (mode == DISPLAY_COLOR_444);
+    _line_valid = false;
+    write_command(ST77XX_COLMOD);
+    write_data(_rgb444 ? 0x53 : 0x55);
+    bus_release();
+}
+
+display_color_mode_t display_get_color_mode(void) {
+    return _rgb444 ? DISPLAY_COLOR_444 : DISPLAY_COLOR_565;
+}
+
 void display_draw_pixel(uint16_t x, uint16_t y, uint16_t color) {
     // Check if coordinates are in bounds
     if (x >= _width || y >= _height) {
         return;
     }
+
+    display_wait_idle();
     
     // Set address window to single pixel
-    display_set_addr_window(x, y, x, y);
+    set_addr_window(x, y, x, y);
     
     // Send color
-    set_dc_pin(1);  // Data mode
-    cs_control(SSP_CS_ENABLE);
-    write_data16(color);
-    cs_control(SSP_CS_DISABLE);
+    STATS_ADD(pixels, 1);
+    write_data16(_rgb444 ? DISPLAY_RGB444(color) << 4 : color);
+    bus_release();
+}
+
+// Start sending a queued window, the SSP interrupt keeps the FIFO topped up
+static void xfer_start(const display_xfer_t *xfer) {
+    set_addr_window(xfer->x0, xfer->y0, xfer->x1, xfer->y1);
+
+    _xfer_data = xfer->data;
+    _xfer_left = xfer->length;
+    STATS_ADD(pixels, xfer->length / 2);
+    STATS_ADD(bytes, window_bytes(xfer->length / 2));
+    xfer_service();
+    ssp_enable_interrupt(SSP_INT_TX_FF);
+}
+
+// Refill the TX FIFO, or finish the active window once all of it is queued.
+// Runs with the SSP interrupt masked or from the interrupt itself.
+__attribute__((section("ram_code"))) static void xfer_service(void) {
+    if (_xfer_left) {
+        // The TX interrupt fires at half empty, so half a FIFO always fits
+        uint32_t n;
+        if (_rgb444) {
+            // 42 pixels pack into 63 bytes
+            n = (_xfer_left < 84) ? _xfer_left : 84;
+            ssp_send_bytes(_pack_buf, pack444(_pack_buf, _xfer_data, n / 2));
+        } else {
+            n = (_xfer_left < SSP_FIFO_SIZE / 2) ? _xfer_left : SSP_FIFO_SIZE / 2;
+            ssp_send_bytes(_xfer_data, n);
+        }
+        _xfer_data += n;
+        _xfer_left -= n;
+        return;
+    }
+
+    ssp_disable_interrupt(SSP_INT_TX_FF);
+    bus_release();
+
+    display_xfer_t done = _xfer_queue[_xfer_head];
+    _xfer_head = (_xfer_head + 1) % DISPLAY_XFER_QUEUE_LEN;
+    _xfer_count--;
+
+    // Keep the bus busy before handing the finished buffer back
+    if (_xfer_count) {
+        xfer_start(&_xfer_queue[_xfer_head]);
+    }
+    if (done.done) {
+        done.done(done.arg);
+    }
+}
+
+// Service the queue by polling, for callers that run with the SSP interrupt masked
+void display_poll(void) {
+    GLOBAL_INT_DISABLE();
+    if (_xfer_count && (ssp_get_isr_status() & SSP_INT_STATUS_TX)) {
+        xfer_service();
+    }
+    GLOBAL_INT_RESTORE();
+}
+
+__attribute__((section("ram_code"))) void ssp_isr_ram(void) {
+    uint32_t status = ssp_get_isr_status();
+
+    if ((status & SSP_INT_STATUS_TX) && _xfer_count) {
+        xfer_service();
+    }
+    ssp_clear_isr_status(status);
+}
+
+void display_fill_window_async(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, const uint16_t* color_buffer,
+                               uint32_t size, display_xfer_cb_t done, void *arg) {
+    if (!_xfer_async) {
+        display_fill_window(x0, y0, x1, y1, (uint16_t *)color_buffer, size);
+        if (done) done(arg);
+        return;
+    }
+
+    // Wait for a free slot
+    while (_xfer_count == DISPLAY_XFER_QUEUE_LEN) {
+        display_poll();
+    }
+
+    GLOBAL_INT_DISABLE();
+    display_xfer_t *xfer = &_xfer_queue[(_xfer_head + _xfer_count) % DISPLAY_XFER_QUEUE_LEN];
+    xfer->x0 = x0;
+    xfer->y0 = y0;
+    xfer->x1 = x1;
+    xfer->y1 = y1;
+    xfer->data = (const uint8_t *)color_buffer;
+    xfer->length = (uint32_t)(x1 - x0 + 1) * (y1 - y0 + 1) * 2;
+    xfer->done = done;
+    xfer->arg = arg;
+    if (_xfer_count++ == 0) {
+        xfer_start(xfer);
+    }
+    GLOBAL_INT_RESTORE();
+}
+
+bool display_scroll_area(uint16_t top, uint16_t h) {
+    if ((_rotation & 1) || h == 0 || top + h > _height) return false;
+
+    display_wait_idle();
+
+    // Panel memory has 320 lines, the ones past the panel go in the bottom fixed area
+    _scroll_flip = (_rotation == 0);
+    _scroll_tfa = panel_line(top, h);
+    _scroll_h = h;
+
+    write_command(ST77XX_VSCRDEF);
+    write_data16(_scroll_tfa);
+    write_data16(_scroll_h);
+    write_data16(320 - _scroll_tfa - _scroll_h);
+    bus_release();
+    return true;
+}
+
+void display_scroll_to(uint16_t offset) {
+    if (!_scroll_h) return;
+
+    display_wait_idle();
+
+    offset %= _scroll_h;
+    if (_scroll_flip && offset) offset = _scroll_h - offset;
+    write_command(ST77XX_VSCSAD);
+    write_data16(_scroll_tfa + offset);
+    bus_release();
+}
+
+void display_scroll_off(void) {
+    display_normal_mode();
+}
+
+bool display_partial_area(uint16_t top, uint16_t h) {
+    if ((_rotation & 1) || h == 0 || top + h > _height) return false;
+
+    display_wait_idle();
+
+    uint16_t first = panel_line(top, h);
+    write_command(ST77XX_PTLAR);
+    write_data16(first);
+    write_data16(first + h - 1);
+    write_command(ST77XX_PTLON);
+    bus_release();
+    _scroll_h = 0;
+    return true;
+}
+
+void display_normal_mode(void) {
+    display_wait_idle();
+    _scroll_h = 0;
+    write_command(ST77XX_NORON);
+    bus_release();
+}
+
+void display_idle_mode(bool on) {
+    display_wait_idle();
+    write_command(on ? ST77XX_IDMON : ST77XX_IDMOFF);
+    bus_release();
+}
+
+// The panel keeps its memory while asleep. Commands need 5 ms after either
+// sleep command, and SLPIN 120 ms after SLPOUT.
+void display_sleep(bool on) {
+    display_wait_idle();
+    if (on) {
+        uint32_t since = time_since_ms(system_get_curr_time(), _slpout_ms);
+        if (since < SLPOUT_TO_SLPIN_MS) delay_ms(SLPOUT_TO_SLPIN_MS - since);
+        write_command(ST77XX_DISPOFF);
+        write_command(ST77XX_SLPIN);
+        bus_release();
+        delay_ms(5);
+    } else {
+        write_command(ST77XX_SLPOUT);
+        bus_release();
+        _slpout_ms = system_get_curr_time();
+        delay_ms(5);
+        write_command(ST77XX_DISPON);
+        bus_release();
+    }
+}
+
+// CS and reset stay high from the PMU while the system sleeps, so the panel
+// neither sees garbage nor resets
+void display_before_sleep(void) {
+    display_wait_idle();
+    pin_to_pmu(DISPLAY_CS_PIN_NAME, DISPLAY_CS_PIN_NUM, 1);
+    pin_to_pmu(DISPLAY_RESET_PIN_NAME, DISPLAY_RESET_PIN_NUM, 1);
+    pin_to_pmu(DISPLAY_DC_PIN_NAME, DISPLAY_DC_PIN_NUM, 1);
+}
+
+void display_after_sleep(void) {
+    bus_init();
+    set_reset_pin(1);
+    pmu_set_pin_to_CPU(DISPLAY_CS_PIN_NAME, 1 << DISPLAY_CS_PIN_NUM);
+    pmu_set_pin_to_CPU(DISPLAY_RESET_PIN_NAME, 1 << DISPLAY_RESET_PIN_NUM);
+    pmu_set_pin_to_CPU(DISPLAY_DC_PIN_NAME, 1 << DISPLAY_DC_PIN_NUM);
+}
+
+void display_set_async(bool enable) {
+    display_wait_idle();
+    _xfer_async = enable;
+}
+
+bool display_is_busy(void) {
+    return _xfer_count != 0;
+}
+
+void display_wait_idle(void) {
+    while (_xfer_count) {
+        display_poll();
+    }
+}
+
+void display_get_stats(display_stats_t *stats) {
+#if DISPLAY_STATS
+    *stats = _stats;
+#else
+    memset(stats, 0, sizeof(*stats));
+#endif
+}
+
+void display_reset_stats(void) {
+#if DISPLAY_STATS
+    memset(&_stats, 0, sizeof(_stats));
+#endif
 }
 
 void backlight_turn_off()
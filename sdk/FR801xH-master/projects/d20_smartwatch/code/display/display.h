@@ -26,6 +26,11 @@
 #define ST77XX_RASET      0x2B
 #define ST77XX_RAMWR      0x2C
 #define ST77XX_RAMRD      0x2E
+#define ST77XX_PTLAR      0x30
+#define ST77XX_VSCRDEF    0x33
+#define ST77XX_VSCSAD     0x37
+#define ST77XX_IDMOFF     0x38
+#define ST77XX_IDMON      0x39
 
 #define ST77XX_COLMOD     0x3A
 #define ST77XX_MADCTL     0x36
@@ -52,13 +57,100 @@
 #define DISPLAY_HEIGHT 240
 #define DISPLAY_WIDTH 240
 
+// The panel takes RGB565 MSB first, buffers handed to display_fill_window must
+// already be in that byte order
+#define DISPLAY_SWAP16(c) ((uint16_t)(((uint16_t)(c) << 8) | ((uint16_t)(c) >> 8)))
+
+// RGB565 to the 12 bit RGB444 the panel takes in DISPLAY_COLOR_444 mode
+#define DISPLAY_RGB444(c) ((uint16_t)((((c) >> 4) & 0xF00) | (((c) >> 3) & 0x0F0) | (((c) >> 1) & 0x00F)))
+
+// SSP clock set up by display_init
+#define DISPLAY_SPI_HZ 24000000
+
+// Count bus traffic for display_get_stats
+#ifndef DISPLAY_STATS
+#define DISPLAY_STATS 1
+#endif
+
+// Windows queued for interrupt driven transfer, one is on the wire
+#ifndef DISPLAY_XFER_QUEUE_LEN
+#define DISPLAY_XFER_QUEUE_LEN 4
+#endif
+
+// Pixel format on the bus. Colors and buffers stay RGB565 either way, in
+// 444 mode they are packed on the way out, 3 bytes for 2 pixels.
+typedef enum {
+    DISPLAY_COLOR_565,
+    DISPLAY_COLOR_444,
+} display_color_mode_t;
+
+// Mode set up by display_init
+#ifndef DISPLAY_COLOR_MODE
+#define DISPLAY_COLOR_MODE DISPLAY_COLOR_565
+#endif
+
+// Called from the SSP interrupt once a queued window has been sent
+typedef void (*display_xfer_cb_t)(void *arg);
+
+typedef struct {
+    uint32_t bytes;     // Everything sent, commands included
+    uint32_t commands;
+    uint32_t windows;   // Address windows set up
+    uint32_t selects;   // CS assertions
+    uint32_t pixels;    // Pixels sent to display RAM
+} display_stats_t;
+
 void display_init(uint16_t width, uint16_t height, uint8_t _rotation);
 void display_fill_window(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, uint16_t* color_buffer, uint32_t size);
 void display_set_addr_window(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1);
+void display_fill_window_color(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, uint16_t color);
 void display_fill_screen(uint16_t color);
 void display_set_rotation(uint8_t m);
 uint16_t display_get_color(uint8_t r, uint8_t g, uint8_t b);
 void display_draw_pixel(uint16_t x, uint16_t y, uint16_t color);
+
+// Switching doesn't touch what's on the panel, only later writes
+void display_set_color_mode(display_color_mode_t mode);
+display_color_mode_t display_get_color_mode(void);
+
+// Hardware vertical scrolling. Rows [top, top + h) become a ring the panel
+// shows starting offset rows in: screen row top + i shows the row written at
+// top + (i + offset) % h. Rows outside the area stay put and drawing keeps
+// going to the rows as written. Only rotations 0 and 2 scroll along screen
+// rows, display_scroll_area returns false for the others.
+// display_scroll_off goes back to normal display mode.
+bool display_scroll_area(uint16_t top, uint16_t h);
+void display_scroll_to(uint16_t offset);
+void display_scroll_off(void);
+
+// Power saving. Partial mode only drives screen rows [top, top + h), the
+// rest shows black, with the same rotation limits as scrolling. Idle mode
+// shows 8 colors, the top bit of each channel. Sleep turns the panel off and
+// keeps its memory. display_normal_mode leaves partial and scroll modes.
+bool display_partial_area(uint16_t top, uint16_t h);
+void display_normal_mode(void);
+void display_idle_mode(bool on);
+void display_sleep(bool on);
+
+// Call around system sleep, peripherals lose their state while it sleeps
+void display_before_sleep(void);
+void display_after_sleep(void);
+
+// Asynchronous transfers, the buffer must stay untouched until done is called.
+// Waits for a free queue slot if all are taken. The blocking functions above
+// wait for the queue to drain first. With async disabled windows are sent
+// before display_fill_window_async returns.
+void display_fill_window_async(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, const uint16_t* color_buffer,
+                               uint32_t size, display_xfer_cb_t done, void *arg);
+void display_set_async(bool enable);
+bool display_is_busy(void);
+void display_wait_idle(void);
+void display_poll(void);
+
+// Bus traffic since the last reset, all zero with DISPLAY_STATS 0
+void display_get_stats(display_stats_t *stats);
+void display_reset_stats(void);
+
 void backlight_turn_off();
 void backlight_turn_on();
 
@@ -0,0 +1,82 @@
+#include "display/display_pm.h"
+#include "driver_system.h"
+
+static display_pm_config_t _cfg;
+static display_pm_state_t _state = DISPLAY_PM_ACTIVE;
+static uint32_t _idle_ms;
+static volatile bool _activity;
+
+static void _enter(display_pm_state_t state) {
+    if (state == _state) return;
+
+    if (_state == DISPLAY_PM_OFF) display_sleep(false);
+
+    switch (state) {
+    case DISPLAY_PM_ACTIVE:
+        display_idle_mode(false);
+        display_normal_mode();
+        backlight_turn_on();
+        system_sleep_disable();
+        _state = state;
+        if (_cfg.wake) _cfg.wake();
+        return;
+    case DISPLAY_PM_AMBIENT:
+        // Draw first so the face is ready when the colors drop
+        if (_cfg.enter_ambient) _cfg.enter_ambient();
+        display_idle_mode(true);
+        if (_cfg.ambient_h) display_partial_area(_cfg.ambient_top, _cfg.ambient_h);
+        if (_cfg.ambient_backlight) {
+            backlight_turn_on();
+        } else {
+            backlight_turn_off();
+        }
+        break;
+    case DISPLAY_PM_OFF:
+        backlight_turn_off();
+        display_sleep(true);
+        break;
+    }
+    system_sleep_enable();
+    _state = state;
+}
+
+void display_pm_init(const display_pm_config_t *cfg) {
+    _cfg = *cfg;
+    _state = DISPLAY_PM_ACTIVE;
+    _idle_ms = 0;
+    _activity = false;
+}
+
+void display_pm_activity(void) {
+    _activity = true;
+}
+
+display_pm_state_t display_pm_update(uint32_t elapsed_ms) {
+    if (_activity) {
+        _activity = false;
+        _idle_ms = 0;
+        _enter(DISPLAY_PM_ACTIVE);
+        return _state;
+    }
+
+    _idle_ms = (_idle_ms + elapsed_ms < _idle_ms) ? UINT32_MAX : _idle_ms + elapsed_ms;
+    if (_state == DISPLAY_PM_ACTIVE && _cfg.ambient_ms && _idle_ms >= _cfg.ambient_ms) {
+        _enter(DISPLAY_PM_AMBIENT);
+    }
+    if (_state != DISPLAY_PM_OFF && _cfg.off_ms && _idle_ms >= _cfg.off_ms) {
+        _enter(DISPLAY_PM_OFF);
+    }
+    return _state;
+}
+
+display_pm_state_t display_pm_get_state(void) {
+    return _state;
+}
+
+void display_pm_before_sleep(void) {
+    if (_state != DISPLAY_PM_ACTIVE) display_before_sleep();
+}
+
+void display_pm_after_sleep(void) {
+    if (_state != DISPLAY_PM_ACTIVE) display_after_sleep();
+}
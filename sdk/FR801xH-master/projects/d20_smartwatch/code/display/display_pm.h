@@ -0,0 +1,39 @@
+#ifndef DISPLAY_PM_H
+#define DISPLAY_PM_H
+
+#include "display/display.h"
+
+// Display power manager. Without activity the panel goes from the full face
+// to an ambient face (idle 8 color mode, optionally only a band of rows
+// driven) and then to sleep with the backlight off. System sleep is allowed
+// whenever the panel isn't active.
+typedef enum {
+    DISPLAY_PM_ACTIVE,
+    DISPLAY_PM_AMBIENT,
+    DISPLAY_PM_OFF,
+} display_pm_state_t;
+
+typedef struct {
+    uint32_t ambient_ms;        // Inactivity before the ambient face, 0 skips it
+    uint32_t off_ms;            // Inactivity before the panel sleeps, 0 never
+    uint16_t ambient_top;       // Rows driven in ambient, ambient_h 0 for all of them
+    uint16_t ambient_h;
+    bool ambient_backlight;     // Keep the backlight on in ambient
+    void (*enter_ambient)(void);    // Draw the ambient face, optional
+    void (*wake)(void);         // Redraw the full face, optional
+} display_pm_config_t;
+
+void display_pm_init(const display_pm_config_t *cfg);
+
+// Button presses and the like, safe to call from interrupts
+void display_pm_activity(void);
+
+// Run the timeouts, returns the new state
+display_pm_state_t display_pm_update(uint32_t elapsed_ms);
+display_pm_state_t display_pm_get_state(void);
+
+// From user_entry_before_sleep_imp and user_entry_after_sleep_imp
+void display_pm_before_sleep(void);
+void display_pm_after_sleep(void);
+
+#endif // DISPLAY_PM_H
@@ -5,6 +5,8 @@ static uint16_t _width;
 static uint16_t _height;
 static int16_t WIDTH, HEIGHT; // Original dimensions
 
+static uint16_t _aa_bg = 0x0000;            // Assumed under anti-aliased edges outside a band
+
 static const GFXfont *_font = NULL;
 static uint16_t _text_color = 0xFFFF;       // Default: white
 static uint16_t _text_bg_color = 0x0000;    // Default: black
@@ -13,6 +15,262 @@ static bool _wrap = true;
 static int16_t _cursor_x = 0;
 static int16_t _cursor_y = 0;
 
+// Band renderer
+static gfx_render_mode_t _render_mode = GFX_RENDER_DIRECT;
+static uint16_t _band_buf[GFX_BAND_BUFFERS][GFX_BAND_PIXELS]; // Pixels in panel byte order
+static volatile bool _band_busy[GFX_BAND_BUFFERS];          // Buffer is queued for the panel
+static uint8_t _band_cur;                   // Buffer being drawn into
+static bool _band_active = false;           // Inside a gfx_band_begin/gfx_band_next loop
+static int16_t _band_x, _band_y;            // Band origin on screen
+static int16_t _band_w, _band_h;            // Band size, _band_w * _band_h <= GFX_BAND_PIXELS
+static uint16_t _band_bg;                   // Color every band starts with
+
+// Frame display list
+typedef enum {
+    GFX_OP_PIXEL,
+    GFX_OP_LINE,
+    GFX_OP_DASHED_LINE,
+    GFX_OP_V_LINE,
+    GFX_OP_H_LINE,
+    GFX_OP_FILL_RECT,
+    GFX_OP_ROUND_RECT,
+    GFX_OP_FILL_ROUND_RECT,
+    GFX_OP_CIRCLE,
+    GFX_OP_FILL_CIRCLE,
+    GFX_OP_CIRCLE_HELPER,
+    GFX_OP_FILL_CIRCLE_HELPER,
+    GFX_OP_ARC,
+    GFX_OP_LINE_AA,
+    GFX_OP_THICK_LINE_AA,
+    GFX_OP_CIRCLE_AA,
+    GFX_OP_FILL_CIRCLE_AA,
+    GFX_OP_ARC_AA,
+    GFX_OP_ELLIPSE,
+    GFX_OP_FILL_ELLIPSE,
+    GFX_OP_FILL_TRIANGLE,
+    GFX_OP_FILL_POLYGON,
+    GFX_OP_BITMAP,
+    GFX_OP_BITMAP_BG,
+    GFX_OP_RGB_BITMAP,
+    GFX_OP_RGB_BITMAP_MASK,
+    GFX_OP_SCALED_BITMAP,
+    GFX_OP_IMAGE,
+    GFX_OP_CHAR,
+} gfx_op_t;
+
+typedef struct {
+    uint8_t op;
+    uint8_t arg;        // Thickness, corner mask, point count, dash length or text size
+    uint16_t color;
+    int16_t v[6];       // Coordinates and sizes in call order
+    const void *p0;     // Bitmap, image, polygon points or font
+    const void *p1;     // Bitmap mask
+} gfx_cmd_t;
+
+static gfx_cmd_t _frame_cmds[GFX_FRAME_MAX_CMDS];
+static uint16_t _frame_cmd_count;
+static gfx_rect_t _frame_rects[GFX_FRAME_MAX_RECTS];
+static uint8_t _frame_rect_count;
+static uint16_t _frame_bg;
+static bool _frame_open = false;        // Inside gfx_begin_frame/gfx_end_frame
+static bool _frame_recording = false;   // Primitives go to the display list
+
+// Glyph cache, a slot is free while used is 0
+typedef struct {
+    const GFXfont *font;
+    uint16_t fg, bg;
+    uint8_t c, size;
+    uint32_t used;              // _glyph_tick at the last hit
+} gfx_glyph_slot_t;
+
+#if GFX_GLYPH_CACHE_SLOTS > 0
+static gfx_glyph_slot_t _glyph_slots[GFX_GLYPH_CACHE_SLOTS];
+static uint16_t _glyph_pool[GFX_GLYPH_CACHE_SLOTS][GFX_GLYPH_CACHE_SLOT_PIXELS]; // Panel byte order
+#endif
+static uint32_t _glyph_tick;
+static uint32_t _glyph_hits;
+static uint32_t _glyph_misses;
+
+// Image decoder position, a band resumes where the one above it stopped
+static const gfx_image_t *_image_img;
+static const uint8_t *_image_data;
+static uint16_t _image_row;
+
+static bool _frame_push(uint8_t op, uint8_t arg, uint16_t color,
+                        int16_t v0, int16_t v1, int16_t v2, int16_t v3, int16_t v4, int16_t v5,
+                        const void *p0, const void *p1);
+static void _frame_flush(void);
+
+// Fill a rectangle into the active band, clipped to the band
+static void _band_fill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    int16_t x2 = x + w;
+    int16_t y2 = y + h;
+
+    if (x < _band_x) x = _band_x;
+    if (y < _band_y) y = _band_y;
+    if (x2 > _band_x + _band_w) x2 = _band_x + _band_w;
+    if (y2 > _band_y + _band_h) y2 = _band_y + _band_h;
+    if (x >= x2 || y >= y2) return;
+
+    uint16_t c = DISPLAY_SWAP16(color);
+    uint16_t *row = &_band_buf[_band_cur][(y - _band_y) * _band_w + (x - _band_x)];
+    for (; y < y2; y++, row += _band_w) {
+        for (int16_t i = 0; i < x2 - x; i++) {
+            row[i] = c;
+        }
+    }
+}
+
+static void _band_sent(void *arg) {
+    *(volatile bool *)arg = false;
+}
+
+// Queue the active band for the panel and switch to the next buffer, once the
+// panel is done with it
+static void _band_flush(void) {
+    _band_busy[_band_cur] = true;
+    display_fill_window_async(_band_x, _band_y, _band_x + _band_w - 1, _band_y + _band_h - 1,
+                              _band_buf[_band_cur], (uint32_t)_band_w * _band_h,
+                              _band_sent, (void *)&_band_busy[_band_cur]);
+
+    _band_cur = (_band_cur + 1) % GFX_BAND_BUFFERS;
+    while (_band_busy[_band_cur]) {
+        display_poll();
+    }
+}
+
+// Draw the rectangle in RAM bands starting from bg, each band is sent with one
+// window. draw runs once per band with the band active.
+static void _band_render(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t bg,
+                         void (*draw)(void *arg), void *arg) {
+    int16_t x2 = x + w;
+    int16_t y2 = y + h;
+
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x2 > _width) x2 = _width;
+    if (y2 > _height) y2 = _height;
+    if (x >= x2 || y >= y2) return;
+
+    int16_t rows = GFX_BAND_PIXELS / (x2 - x);
+
+    _band_x = x;
+    _band_w = x2 - x;
+    _band_active = true;
+
+    for (_band_y = y; _band_y < y2; _band_y += rows) {
+        _band_h = (y2 - _band_y < rows) ? y2 - _band_y : rows;
+        _band_fill(_band_x, _band_y, _band_w, _band_h, bg);
+        draw(arg);
+        _band_flush();
+    }
+
+    _band_active = false;
+}
+
+// Span sinks. Shapes hand their pixels over as rectangles (runs when h is 1)
+// and batches of single points, already clipped to the screen.
+
+static void _panel_fill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, void *arg) {
+    display_fill_window_color(x, y, x + w - 1, y + h - 1, color);
+}
+
+// Points in row order, neighbours on a row go out as one window
+static void _panel_points(gfx_point_t *pts, uint16_t n, uint16_t color, void *arg) {
+    if (n == 1) {
+        display_draw_pixel(pts[0].x, pts[0].y, color);
+        return;
+    }
+
+    for (uint16_t i = 1; i < n; i++) {
+        gfx_point_t p = pts[i];
+        uint16_t k = i;
+        for (; k > 0 && (pts[k - 1].y > p.y || (pts[k - 1].y == p.y && pts[k - 1].x > p.x)); k--) {
+            pts[k] = pts[k - 1];
+        }
+        pts[k] = p;
+    }
+
+    uint16_t i = 0;
+    while (i < n) {
+        int16_t x = pts[i].x, y = pts[i].y, x2 = x;
+        for (i++; i < n && pts[i].y == y && pts[i].x <= x2 + 1; i++) {
+            x2 = pts[i].x;
+        }
+        display_fill_window_color(x, y, x2, y, color);
+    }
+}
+
+static void _band_sink_fill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, void *arg) {
+    _band_fill(x, y, w, h, color);
+}
+
+static void _band_points(gfx_point_t *pts, uint16_t n, uint16_t color, void *arg) {
+    uint16_t c = DISPLAY_SWAP16(color);
+
+    for (uint16_t i = 0; i < n; i++) {
+        int16_t x = pts[i].x - _band_x, y = pts[i].y - _band_y;
+        if (x >= 0 && x < _band_w && y >= 0 && y < _band_h) {
+            _band_buf[_band_cur][y * _band_w + x] = c;
+        }
+    }
+}
+
+static const gfx_span_sink_t _panel_sink = { _panel_fill, _panel_points, NULL };
+static const gfx_span_sink_t _band_sink = { _band_sink_fill, _band_points, NULL };
+static const gfx_span_sink_t *_user_sink;
+
+static gfx_point_t _pt_batch[GFX_POINT_BATCH];
+static uint16_t _pt_count;
+static uint16_t _pt_color;
+
+const gfx_span_sink_t *gfx_builtin_span_sink(void) {
+    return _band_active ? &_band_sink : &_panel_sink;
+}
+
+static const gfx_span_sink_t *_sink(void) {
+    return _user_sink ? _user_sink : gfx_builtin_span_sink();
+}
+
+static void _plot_flush(void) {
+    if (_pt_count) {
+        const gfx_span_sink_t *sink = _sink();
+        sink->points(_pt_batch, _pt_count, _pt_color, sink->arg);
+        _pt_count = 0;
+    }
+}
+
+void gfx_set_span_sink(const gfx_span_sink_t *sink) {
+    _plot_flush();
+    _user_sink = sink;
+}
+
+// Queue a point for the sink, callers finish with _plot_flush()
+static void _plot(int16_t x, int16_t y, uint16_t color) {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+    if (_pt_count == GFX_POINT_BATCH || (_pt_count && color != _pt_color)) _plot_flush();
+    _pt_batch[_pt_count].x = x;
+    _pt_batch[_pt_count].y = y;
+    _pt_color = color;
+    _pt_count++;
+}
+
+// Clip a rectangle to the screen and pass it on
+static void _sink_fill(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) {
+    int32_t x2 = x + w;
+    int32_t y2 = y + h;
+
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x2 > _width) x2 = _width;
+    if (y2 > _height) y2 = _height;
+    if (x >= x2 || y >= y2) return;
+
+    const gfx_span_sink_t *sink = _sink();
+    _plot_flush();
+    sink->fill(x, y, x2 - x, y2 - y, color, sink->arg);
+}
+
 // Set the font to use for text rendering
 void gfx_set_font(const GFXfont *f) {
     _font = f;
@@ -62,12 +320,124 @@ void gfx_draw_text(int16_t x, int16_t y, const char *str, uint16_t color) {
     _cursor_y = orig_y;
 }
 
+typedef struct {
+    int16_t x, y;
+    unsigned char c;
+    uint16_t color;
+    uint8_t size;
+} gfx_char_args_t;
+
+// Glyph drawn over a band that already holds the background
+static void _draw_char_band(void *arg) {
+    const gfx_char_args_t *a = (const gfx_char_args_t *)arg;
+    gfx_draw_char(a->x, a->y, a->c, a->color, a->color, a->size);
+}
+
+// One run of set or clear glyph bits, clear runs only show on opaque text
+static void _draw_char_run(int16_t x, int16_t y, uint8_t len, bool on, uint16_t color, uint16_t bg, uint8_t size) {
+    if (on) {
+        gfx_fill_rect(x, y, len * size, size, color);
+    } else if (bg != color) {
+        gfx_fill_rect(x, y, len * size, size, bg);
+    }
+}
+
+// Copy a block in panel byte order into the active band, clipped to the band
+static void _band_blit(const uint16_t *src, int16_t x, int16_t y, int16_t w, int16_t h) {
+    int16_t x1 = (x > _band_x) ? x : _band_x;
+    int16_t y1 = (y > _band_y) ? y : _band_y;
+    int16_t x2 = (x + w < _band_x + _band_w) ? x + w : _band_x + _band_w;
+    int16_t y2 = (y + h < _band_y + _band_h) ? y + h : _band_y + _band_h;
+    if (x1 >= x2 || y1 >= y2) return;
+
+    src += (y1 - y) * w + (x1 - x);
+    uint16_t *dst = &_band_buf[_band_cur][(y1 - _band_y) * _band_w + (x1 - _band_x)];
+    for (; y1 < y2; y1++, src += w, dst += _band_w) {
+        memcpy(dst, src, (x2 - x1) * sizeof(uint16_t));
+    }
+}
+
+// Find an opaque glyph in the cache, rasterizing it into the least recently
+// used slot on a miss. Returns NULL when the block does not fit in a slot.
+static const uint16_t *_glyph_cache_get(const GFXglyph *glyph, unsigned char c, uint16_t fg, uint16_t bg, uint8_t size) {
+#if GFX_GLYPH_CACHE_SLOTS > 0
+    uint16_t bw = glyph->width * size;
+    uint16_t bh = glyph->height * size;
+    if ((uint32_t)bw * bh > GFX_GLYPH_CACHE_SLOT_PIXELS) return NULL;
+
+    gfx_glyph_slot_t *victim = &_glyph_slots[0];
+    _glyph_tick++;
+
+    for (uint8_t i = 0; i < GFX_GLYPH_CACHE_SLOTS; i++) {
+        gfx_glyph_slot_t *slot = &_glyph_slots[i];
+        if (slot->used && slot->font == _font && slot->c == c && slot->size == size &&
+            slot->fg == fg && slot->bg == bg) {
+            slot->used = _glyph_tick;
+            _glyph_hits++;
+            return _glyph_pool[i];
+        }
+        if (slot->used < victim->used) victim = slot;
+    }
+
+    _glyph_misses++;
+    victim->font = _font;
+    victim->c = c;
+    victim->size = size;
+    victim->fg = fg;
+    victim->bg = bg;
+    victim->used = _glyph_tick;
+
+    // Rasterize, each glyph bit becomes a size x size block
+    uint16_t *pix = _glyph_pool[victim - _glyph_slots];
+    const uint8_t *bitmap = &_font->bitmap[glyph->bitmapOffset];
+    uint16_t fg_sw = DISPLAY_SWAP16(fg);
+    uint16_t bg_sw = DISPLAY_SWAP16(bg);
+    uint8_t bits = 0, bit = 0;
+
+    for (uint8_t yy = 0; yy < glyph->height; yy++) {
+        uint16_t *row = &pix[yy * size * bw];
+        for (uint8_t xx = 0; xx < glyph->width; xx++) {
+            if (!(bit++ & 7)) {
+                bits = *bitmap++;
+            }
+            uint16_t c16 = (bits & 0x80) ? fg_sw : bg_sw;
+            bits <<= 1;
+            for (uint8_t sx = 0; sx < size; sx++) {
+                row[xx * size + sx] = c16;
+            }
+        }
+        for (uint8_t sy = 1; sy < size; sy++) {
+            memcpy(&row[sy * bw], row, bw * sizeof(uint16_t));
+        }
+    }
+    return pix;
+#else
+    return NULL;
+#endif
+}
+
+void gfx_glyph_cache_clear(void) {
+#if GFX_GLYPH_CACHE_SLOTS > 0
+    memset(_glyph_slots, 0, sizeof(_glyph_slots));
+#endif
+    _glyph_tick = 0;
+    _glyph_hits = 0;
+    _glyph_misses = 0;
+}
+
+void gfx_glyph_cache_stats(uint32_t *hits, uint32_t *misses) {
+    *hits = _glyph_hits;
+    *misses = _glyph_misses;
+}
+
 // Draw a single character
 int16_t gfx_draw_char(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
     if (!_font) {
         // Handle case for built-in font (not implemented here)
         return 0;
     }
+
+    bool recorded = _frame_push(GFX_OP_CHAR, size, color, x, y, c, (int16_t)bg, 0, 0, _font, NULL);
     
     // Check if character is valid
     if (c < _font->first || c > _font->last)
@@ -92,66 +462,56 @@ int16_t gfx_draw_char(int16_t x, int16_t y, unsigned char c, uint16_t color, uin
         yo16 *= size;
     }
     
-    // Calculate actual pixel positions
-    int16_t x_pixel, y_pixel;
+    // Skip glyphs that were recorded or don't touch the active band
+    if (recorded || (_band_active && (y + yo16 >= _band_y + _band_h || y + yo16 + h * size <= _band_y))) {
+        return glyph->xAdvance * size;
+    }
+
+    int16_t gx = x + xo16;
+    int16_t gy = y + yo16;
+
+    // Cached opaque glyphs are copied as a block, the band clips them but
+    // straight to the panel only whole glyphs go
+    if (bg != color && w > 0 && h > 0 &&
+        (_band_active || (gx >= 0 && gy >= 0 && gx + w * size <= _width && gy + h * size <= _height))) {
+        const uint16_t *block = _glyph_cache_get(glyph, c + _font->first, color, bg, size);
+        if (block && _band_active) {
+            _band_blit(block, gx, gy, w * size, h * size);
+            return glyph->xAdvance * size;
+        }
+        if (block) {
+            display_fill_window(gx, gy, gx + w * size - 1, gy + h * size - 1, (uint16_t *)block, (uint32_t)w * size * h * size);
+            return glyph->xAdvance * size;
+        }
+    }
+
+    // Opaque glyphs drawn straight to the panel go out as one window
+    if (bg != color && !_band_active) {
+        gfx_char_args_t args = { x, y, c + _font->first, color, size };
+        _band_render(gx, gy, w * size, h * size, bg, _draw_char_band, &args);
+        return glyph->xAdvance * size;
+    }
     
-    // Draw character
+    // Draw character as horizontal runs of equal bits
     for (yy = 0; yy < h; yy++) {
+        uint8_t run = 0;
+        bool run_on = false;
+
         for (xx = 0; xx < w; xx++) {
             if (!(bit++ & 7)) {
                 bits = bitmap[bo++];
             }
-            
-            // Calculate actual pixel position with scaling
-            x_pixel = x + xo16 + (xx * size);
-            y_pixel = y + yo16 + (yy * size);
-            
-            // Only draw if pixel is within display bounds
-            if (bits & 0x80) {
-                if (size == 1) {
-                    if (x_pixel >= 0 && y_pixel >= 0 && x_pixel < _width && y_pixel < _height) {
-                        gfx_draw_pixel(x_pixel, y_pixel, color);
-                    }
-                } else {
-                    // For scaled text, check boundaries for the entire scaled pixel
-                    if (x_pixel >= 0 && y_pixel >= 0 && x_pixel + size - 1 < _width && y_pixel + size - 1 < _height) {
-                        gfx_fill_rect(x_pixel, y_pixel, size, size, color);
-                    } else {
-                        // Partial drawing for pixels at the edge of the display
-                        for (uint8_t sx = 0; sx < size; sx++) {
-                            for (uint8_t sy = 0; sy < size; sy++) {
-                                if ((x_pixel + sx) >= 0 && (y_pixel + sy) >= 0 && 
-                                    (x_pixel + sx) < _width && (y_pixel + sy) < _height) {
-                                    gfx_draw_pixel(x_pixel + sx, y_pixel + sy, color);
-                                }
-                            }
-                        }
-                    }
-                }
-            } else if (bg != color) {
-                if (size == 1) {
-                    if (x_pixel >= 0 && y_pixel >= 0 && x_pixel < _width && y_pixel < _height) {
-                        gfx_draw_pixel(x_pixel, y_pixel, bg);
-                    }
-                } else {
-                    // For scaled text, check boundaries for the entire scaled pixel
-                    if (x_pixel >= 0 && y_pixel >= 0 && x_pixel + size - 1 < _width && y_pixel + size - 1 < _height) {
-                        gfx_fill_rect(x_pixel, y_pixel, size, size, bg);
-                    } else {
-                        // Partial drawing for pixels at the edge of the display
-                        for (uint8_t sx = 0; sx < size; sx++) {
-                            for (uint8_t sy = 0; sy < size; sy++) {
-                                if ((x_pixel + sx) >= 0 && (y_pixel + sy) >= 0 && 
-                                    (x_pixel + sx) < _width && (y_pixel + sy) < _height) {
-                                    gfx_draw_pixel(x_pixel + sx, y_pixel + sy, bg);
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+            bool on = (bits & 0x80) != 0;
             bits <<= 1;
+
+            if (xx > 0 && on != run_on) {
+                _draw_char_run(gx + (xx - run) * size, gy + yy * size, run, run_on, color, bg, size);
+                run = 0;
+            }
+            run_on = on;
+            run++;
         }
+        _draw_char_run(gx + (w - run) * size, gy + yy * size, run, run_on, color, bg, size);
     }
     
     // Return width of character
@@ -241,8 +601,89 @@ void gfx_write_char(char c) {
     }
 }
 
+typedef struct {
+    const char *str;
+    const char *end;
+    int16_t x, y;
+} gfx_text_args_t;
+
+// Line of text drawn over a band that already holds the background. A glyph
+// clear of those before it goes on opaque, through the glyph cache. One that
+// overlaps them, like FreeSans '_' does, goes on transparent, its box would
+// paint over its neighbour.
+static void _draw_text_band(void *arg) {
+    const gfx_text_args_t *a = (const gfx_text_args_t *)arg;
+    int16_t x = a->x;
+    int16_t right = INT16_MIN;
+
+    for (const char *p = a->str; p < a->end; p++) {
+        unsigned char c = *p;
+        if (c < _font->first || c > _font->last) c = '?';
+        const GFXglyph *glyph = &_font->glyph[c - _font->first];
+        int16_t gx = x + glyph->xOffset * _text_size;
+
+        uint16_t bg = (gx >= right) ? _text_bg_color : _text_color;
+        x += gfx_draw_char(x, a->y, *p, _text_color, bg, _text_size);
+        if (glyph->width && gx + glyph->width * _text_size > right) right = gx + glyph->width * _text_size;
+    }
+}
+
+// Print opaque text straight to the panel, one window per line of text
+static void _print_opaque(const char *str) {
+    int16_t line_h = _font->yAdvance * _text_size;
+
+    while (*str) {
+        if (*str == '\n' || *str == '\r') {
+            gfx_write_char(*str++);
+            continue;
+        }
+
+        // Collect the rest of the line, wrapping where gfx_write_char would
+        gfx_text_args_t args = { str, str, _cursor_x, _cursor_y };
+        int16_t x = _cursor_x;
+        int16_t x1 = x, x2 = x, y1 = INT16_MAX, y2 = INT16_MIN;
+        bool wrapped = false;
+
+        while (*args.end && *args.end != '\n' && *args.end != '\r') {
+            unsigned char c = *args.end++;
+            if (c < _font->first || c > _font->last) c = '?';
+            const GFXglyph *glyph = &_font->glyph[c - _font->first];
+
+            int16_t gx = x + glyph->xOffset * _text_size;
+            int16_t gy = _cursor_y + glyph->yOffset * _text_size;
+            if (gx < x1) x1 = gx;
+            if (gx + glyph->width * _text_size > x2) x2 = gx + glyph->width * _text_size;
+            if (gy < y1) y1 = gy;
+            if (gy + glyph->height * _text_size > y2) y2 = gy + glyph->height * _text_size;
+
+            x += glyph->xAdvance * _text_size;
+            if (x > x2) x2 = x;
+            if (_wrap && x > _width - line_h) {
+                wrapped = true;
+                break;
+            }
+        }
+
+        if (y1 < y2) {
+            _band_render(x1, y1, x2 - x1, y2 - y1, _text_bg_color, _draw_text_band, &args);
+        }
+
+        _cursor_x = x;
+        if (wrapped) {
+            _cursor_y += line_h;
+            _cursor_x = 0;
+        }
+        str = args.end;
+    }
+}
+
 // Print a string of text
 void gfx_print(const char *str) {
+    if (_font && _text_bg_color != _text_color && !_band_active && !_frame_recording) {
+        _print_opaque(str);
+        return;
+    }
+
     while (*str) {
         gfx_write_char(*str++);
     }
@@ -257,21 +698,385 @@ static void _swap_int16(int16_t *a, int16_t *b) {
 
 // Initialize the GFX library
 void gfx_init(uint16_t width, uint16_t height, uint8_t rotation) {
+    gfx_init_mode(width, height, rotation, GFX_RENDER_DIRECT);
+}
+
+// Initialize the GFX library with a specific render mode
+void gfx_init_mode(uint16_t width, uint16_t height, uint8_t rotation, gfx_render_mode_t mode) {
     _width = width;
     _height = height;
     WIDTH = width;
     HEIGHT = height;
+    _render_mode = mode;
+    _band_active = false;
     display_init(width, height, rotation);
 }
 
+gfx_render_mode_t gfx_get_render_mode(void) {
+    return _render_mode;
+}
+
+// Start a banded frame, the first band covers the top rows of the screen
+void gfx_band_begin(uint16_t bg) {
+    int16_t rows = GFX_BAND_PIXELS / _width;
+
+    _band_bg = bg;
+    if (_render_mode != GFX_RENDER_BAND || rows < 1) {
+        // Draw straight to the panel, the loop body runs once
+        _band_active = false;
+        gfx_fill_screen(bg);
+        return;
+    }
+
+    _band_x = 0;
+    _band_y = 0;
+    _band_w = _width;
+    _band_h = (rows < _height) ? rows : _height;
+    _band_active = true;
+    _band_fill(_band_x, _band_y, _band_w, _band_h, _band_bg);
+}
+
+// Flush the current band with one address window and move to the next one.
+// Returns false once the whole screen has been sent.
+bool gfx_band_next(void) {
+    if (!_band_active) return false;
+
+    _band_flush();
+
+    _band_y += _band_h;
+    if (_band_y >= _height) {
+        _band_active = false;
+        return false;
+    }
+    if (_band_y + _band_h > _height) _band_h = _height - _band_y;
+    _band_fill(_band_x, _band_y, _band_w, _band_h, _band_bg);
+    return true;
+}
+
+// Overlapping rectangles, or rectangles sharing part of an edge
+static bool _rect_touch(const gfx_rect_t *a, const gfx_rect_t *b) {
+    int16_t ox = ((a->x + a->w < b->x + b->w) ? a->x + a->w : b->x + b->w) - ((a->x > b->x) ? a->x : b->x);
+    int16_t oy = ((a->y + a->h < b->y + b->h) ? a->y + a->h : b->y + b->h) - ((a->y > b->y) ? a->y : b->y);
+    return (ox >= 0 && oy > 0) || (ox > 0 && oy >= 0);
+}
+
+static gfx_rect_t _rect_union(const gfx_rect_t *a, const gfx_rect_t *b) {
+    gfx_rect_t r;
+    int16_t x2 = (a->x + a->w > b->x + b->w) ? a->x + a->w : b->x + b->w;
+    int16_t y2 = (a->y + a->h > b->y + b->h) ? a->y + a->h : b->y + b->h;
+    r.x = (a->x < b->x) ? a->x : b->x;
+    r.y = (a->y < b->y) ? a->y : b->y;
+    r.w = x2 - r.x;
+    r.h = y2 - r.y;
+    return r;
+}
+
+// Add a rectangle to a dirty region list, merging it with every region it
+// touches. When the list is full it is merged with the region that grows least.
+static void _region_add(gfx_rect_t *rects, uint8_t *count, uint8_t max, int32_t x, int32_t y, int32_t w, int32_t h) {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > _width) w = _width - x;
+    if (y + h > _height) h = _height - y;
+    if (w <= 0 || h <= 0) return;
+
+    gfx_rect_t r = { (int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h };
+
+    for (;;) {
+        int16_t idx = -1;
+
+        for (uint8_t i = 0; i < *count; i++) {
+            if (_rect_touch(&r, &rects[i])) {
+                idx = i;
+                break;
+            }
+        }
+
+        if (idx < 0 && *count == max) {
+            int32_t best = INT32_MAX;
+            for (uint8_t i = 0; i < *count; i++) {
+                gfx_rect_t u = _rect_union(&r, &rects[i]);
+                int32_t growth = (int32_t)u.w * u.h - (int32_t)rects[i].w * rects[i].h;
+                if (growth < best) {
+                    best = growth;
+                    idx = i;
+                }
+            }
+        }
+
+        if (idx < 0) break;
+
+        // The union may now touch regions it did not touch before, so rescan
+        r = _rect_union(&r, &rects[idx]);
+        rects[idx] = rects[--*count];
+    }
+
+    rects[(*count)++] = r;
+}
+
+static void _frame_add_rect(int32_t x, int32_t y, int32_t w, int32_t h) {
+    _region_add(_frame_rects, &_frame_rect_count, GFX_FRAME_MAX_RECTS, x, y, w, h);
+}
+
+// Screen area a recorded primitive can touch, not clipped
+static void _frame_cmd_bounds(const gfx_cmd_t *cmd, int32_t *x, int32_t *y, int32_t *w, int32_t *h) {
+    const int16_t *v = cmd->v;
+    int32_t x1, y1, x2, y2;
+
+    switch (cmd->op) {
+    case GFX_OP_PIXEL:
+        *x = v[0]; *y = v[1]; *w = 1; *h = 1;
+        return;
+    case GFX_OP_V_LINE:
+        *x = v[0]; *y = v[1]; *w = 1; *h = v[2];
+        return;
+    case GFX_OP_H_LINE:
+        *x = v[0]; *y = v[1]; *w = v[2]; *h = 1;
+        return;
+    case GFX_OP_LINE:
+    case GFX_OP_LINE_AA:
+    case GFX_OP_DASHED_LINE:
+    case GFX_OP_FILL_TRIANGLE:
+    case GFX_OP_FILL_POLYGON: {
+        const int16_t *pts = v;
+        uint8_t n = (cmd->op == GFX_OP_FILL_TRIANGLE) ? 3 : 2;
+        if (cmd->op == GFX_OP_FILL_POLYGON) {
+            pts = (const int16_t *)cmd->p0;
+            n = cmd->arg;
+        }
+        x1 = x2 = pts[0];
+        y1 = y2 = pts[1];
+        for (uint8_t i = 1; i < n; i++) {
+            if (pts[i*2] < x1) x1 = pts[i*2];
+            if (pts[i*2] > x2) x2 = pts[i*2];
+            if (pts[i*2+1] < y1) y1 = pts[i*2+1];
+            if (pts[i*2+1] > y2) y2 = pts[i*2+1];
+        }
+        *x = x1; *y = y1; *w = x2 - x1 + 1; *h = y2 - y1 + 1;
+        return;
+    }
+    case GFX_OP_FILL_RECT:
+    case GFX_OP_ROUND_RECT:
+    case GFX_OP_FILL_ROUND_RECT:
+    case GFX_OP_BITMAP:
+    case GFX_OP_BITMAP_BG:
+    case GFX_OP_RGB_BITMAP:
+    case GFX_OP_RGB_BITMAP_MASK:
+    case GFX_OP_IMAGE:
+        *x = v[0]; *y = v[1]; *w = v[2]; *h = v[3];
+        return;
+    case GFX_OP_SCALED_BITMAP: {
+        int32_t scale = (v[4] < 1) ? 1 : v[4];
+        *x = v[0]; *y = v[1]; *w = v[2] * scale; *h = v[3] * scale;
+        return;
+    }
+    case GFX_OP_CIRCLE:
+    case GFX_OP_FILL_CIRCLE:
+    case GFX_OP_CIRCLE_HELPER:
+    case GFX_OP_ARC:
+        *x = v[0] - v[2]; *y = v[1] - v[2]; *w = 2 * v[2] + 1; *h = 2 * v[2] + 1;
+        return;
+    case GFX_OP_CIRCLE_AA:
+    case GFX_OP_FILL_CIRCLE_AA:
+    case GFX_OP_ARC_AA:
+        *x = v[0] - v[2] - 1; *y = v[1] - v[2] - 1; *w = 2 * v[2] + 3; *h = 2 * v[2] + 3;
+        return;
+    case GFX_OP_THICK_LINE_AA: {
+        int32_t m = cmd->arg / 2 + 1;
+        x1 = (v[0] < v[2]) ? v[0] : v[2];
+        y1 = (v[1] < v[3]) ? v[1] : v[3];
+        *x = x1 - m; *y = y1 - m; *w = abs(v[2] - v[0]) + 2 * m + 1; *h = abs(v[3] - v[1]) + 2 * m + 1;
+        return;
+    }
+    case GFX_OP_FILL_CIRCLE_HELPER:
+        *x = v[0] - v[2]; *y = v[1] - v[2]; *w = 2 * v[2] + 1; *h = 2 * v[2] + v[3] + 2;
+        return;
+    case GFX_OP_ELLIPSE:
+    case GFX_OP_FILL_ELLIPSE: {
+        int32_t rx = (v[2] < 2) ? 2 : v[2];
+        int32_t ry = (v[3] < 2) ? 2 : v[3];
+        *x = v[0] - rx; *y = v[1] - ry; *w = 2 * rx + 1; *h = 2 * ry + 1;
+        return;
+    }
+    case GFX_OP_CHAR: {
+        const GFXfont *font = (const GFXfont *)cmd->p0;
+        uint8_t c = (uint8_t)v[2];
+        if (c < font->first || c > font->last) c = '?';
+        const GFXglyph *glyph = &font->glyph[c - font->first];
+        *x = v[0] + glyph->xOffset * cmd->arg;
+        *y = v[1] + glyph->yOffset * cmd->arg;
+        *w = glyph->width * cmd->arg;
+        *h = glyph->height * cmd->arg;
+        return;
+    }
+    default:
+        *x = 0; *y = 0; *w = _width; *h = _height;
+        return;
+    }
+}
+
+// Append a primitive to the display list. Returns false when the caller must
+// draw it directly, either because no frame is being recorded or because the
+// list ran out of room and the frame so far has just been flushed. A primitive
+// entirely off-screen is dropped without taking a slot.
+static bool _frame_push(uint8_t op, uint8_t arg, uint16_t color,
+                        int16_t v0, int16_t v1, int16_t v2, int16_t v3, int16_t v4, int16_t v5,
+                        const void *p0, const void *p1) {
+    if (!_frame_recording) return false;
+
+    gfx_cmd_t cmd;
+    cmd.op = op;
+    cmd.arg = arg;
+    cmd.color = color;
+    cmd.v[0] = v0;
+    cmd.v[1] = v1;
+    cmd.v[2] = v2;
+    cmd.v[3] = v3;
+    cmd.v[4] = v4;
+    cmd.v[5] = v5;
+    cmd.p0 = p0;
+    cmd.p1 = p1;
+
+    int32_t x, y, w, h;
+    _frame_cmd_bounds(&cmd, &x, &y, &w, &h);
+    if (w <= 0 || h <= 0 || x >= _width || y >= _height || x + w <= 0 || y + h <= 0) return true;
+
+    if (_frame_cmd_count == GFX_FRAME_MAX_CMDS) {
+        _frame_recording = false;
+        _frame_flush();
+        return false;
+    }
+
+    _frame_cmds[_frame_cmd_count++] = cmd;
+    _frame_add_rect(x, y, w, h);
+    return true;
+}
+
+// Draw a recorded primitive again, into the active band
+static void _frame_replay(const gfx_cmd_t *cmd) {
+    const int16_t *v = cmd->v;
+
+    switch (cmd->op) {
+    case GFX_OP_PIXEL:              gfx_draw_pixel(v[0], v[1], cmd->color); break;
+    case GFX_OP_LINE:               gfx_draw_line(v[0], v[1], v[2], v[3], cmd->color); break;
+    case GFX_OP_DASHED_LINE:        gfx_draw_dashed_line(v[0], v[1], v[2], v[3], cmd->color, cmd->arg, (uint8_t)v[4]); break;
+    case GFX_OP_V_LINE:             gfx_draw_fast_v_line(v[0], v[1], v[2], cmd->color); break;
+    case GFX_OP_H_LINE:             gfx_draw_fast_h_line(v[0], v[1], v[2], cmd->color); break;
+    case GFX_OP_FILL_RECT:          gfx_fill_rect(v[0], v[1], v[2], v[3], cmd->color); break;
+    case GFX_OP_ROUND_RECT:         gfx_draw_round_rect(v[0], v[1], v[2], v[3], v[4], cmd->color); break;
+    case GFX_OP_FILL_ROUND_RECT:    gfx_fill_round_rect(v[0], v[1], v[2], v[3], v[4], cmd->color); break;
+    case GFX_OP_CIRCLE:             gfx_draw_circle(v[0], v[1], v[2], cmd->color); break;
+    case GFX_OP_FILL_CIRCLE:        gfx_fill_circle(v[0], v[1], v[2], cmd->color); break;
+    case GFX_OP_CIRCLE_HELPER:      gfx_draw_circle_helper(v[0], v[1], v[2], cmd->arg, cmd->color); break;
+    case GFX_OP_FILL_CIRCLE_HELPER: gfx_fill_circle_helper(v[0], v[1], v[2], cmd->arg, v[3], cmd->color); break;
+    case GFX_OP_ARC:                gfx_draw_arc(v[0], v[1], v[2], v[3], v[4], cmd->arg, cmd->color); break;
+    case GFX_OP_LINE_AA:            gfx_draw_line_aa(v[0], v[1], v[2], v[3], cmd->color); break;
+    case GFX_OP_THICK_LINE_AA:      gfx_draw_thick_line_aa(v[0], v[1], v[2], v[3], cmd->arg, cmd->color); break;
+    case GFX_OP_CIRCLE_AA:          gfx_draw_circle_aa(v[0], v[1], v[2], cmd->color); break;
+    case GFX_OP_FILL_CIRCLE_AA:     gfx_fill_circle_aa(v[0], v[1], v[2], cmd->color); break;
+    case GFX_OP_ARC_AA:             gfx_draw_arc_aa(v[0], v[1], v[2], v[3], v[4], cmd->arg, cmd->color); break;
+    case GFX_OP_ELLIPSE:            gfx_draw_ellipse(v[0], v[1], v[2], v[3], cmd->color); break;
+    case GFX_OP_FILL_ELLIPSE:       gfx_fill_ellipse(v[0], v[1], v[2], v[3], cmd->color); break;
+    case GFX_OP_FILL_TRIANGLE:      gfx_fill_triangle(v[0], v[1], v[2], v[3], v[4], v[5], cmd->color); break;
+    case GFX_OP_FILL_POLYGON:       gfx_fill_polygon_rule((int16_t *)cmd->p0, cmd->arg, v[0], cmd->color); break;
+    case GFX_OP_BITMAP:             gfx_draw_bitmap(v[0], v[1], cmd->p0, v[2], v[3], cmd->color); break;
+    case GFX_OP_BITMAP_BG:          gfx_draw_bitmap_bg(v[0], v[1], cmd->p0, v[2], v[3], cmd->color, (uint16_t)v[4]); break;
+    case GFX_OP_RGB_BITMAP:         gfx_draw_rgb_bitmap(v[0], v[1], cmd->p0, v[2], v[3]); break;
+    case GFX_OP_RGB_BITMAP_MASK:    gfx_draw_rgb_bitmap_with_mask(v[0], v[1], cmd->p0, cmd->p1, v[2], v[3]); break;
+    case GFX_OP_SCALED_BITMAP:      gfx_draw_scaled_bitmap(v[0], v[1], cmd->p0, v[2], v[3], v[4], cmd->color); break;
+    case GFX_OP_IMAGE:              gfx_draw_image(v[0], v[1], cmd->p0); break;
+    case GFX_OP_CHAR: {
+        const GFXfont *font = _font;
+        _font = (const GFXfont *)cmd->p0;
+        gfx_draw_char(v[0], v[1], (unsigned char)v[2], cmd->color, (uint16_t)v[3], cmd->arg);
+        _font = font;
+        break;
+    }
+    }
+}
+
+// Draw every recorded primitive that touches the active band
+static void _frame_replay_band(void *arg) {
+    for (uint16_t i = 0; i < _frame_cmd_count; i++) {
+        int32_t x, y, w, h;
+        _frame_cmd_bounds(&_frame_cmds[i], &x, &y, &w, &h);
+        if (x < _band_x + _band_w && x + w > _band_x && y < _band_y + _band_h && y + h > _band_y) {
+            _frame_replay(&_frame_cmds[i]);
+        }
+    }
+}
+
+// Rebuild every dirty region in bands and send each band with one window
+static void _frame_flush(void) {
+    for (uint8_t i = 0; i < _frame_rect_count; i++) {
+        const gfx_rect_t *r = &_frame_rects[i];
+        _band_render(r->x, r->y, r->w, r->h, _frame_bg, _frame_replay_band, NULL);
+    }
+
+    _frame_cmd_count = 0;
+    _frame_rect_count = 0;
+}
+
+// Start recording a frame, dirty regions are rebuilt on top of bg
+void gfx_begin_frame(uint16_t bg) {
+    _frame_bg = bg;
+    _frame_cmd_count = 0;
+    _frame_rect_count = 0;
+    _frame_open = true;
+    _frame_recording = true;
+}
+
+// Flush only the dirty regions of the frame to the panel
+void gfx_end_frame(void) {
+    if (_frame_recording) {
+        _frame_recording = false;
+        _frame_flush();
+    }
+    _frame_open = false;
+}
+
+// Mark an area as changed, it is repainted with bg plus whatever is drawn over it
+void gfx_invalidate(int16_t x, int16_t y, int16_t w, int16_t h) {
+    if (_frame_recording) {
+        _frame_add_rect(x, y, w, h);
+    } else if (_frame_open) {
+        // The display list overflowed earlier in this frame
+        gfx_fill_rect(x, y, w, h, _frame_bg);
+    }
+}
+
+void gfx_region_add(gfx_rect_t *rects, uint8_t *count, uint8_t max, int16_t x, int16_t y, int16_t w, int16_t h) {
+    _region_add(rects, count, max, x, y, w, h);
+}
+
+void gfx_render_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t bg, void (*draw)(void *arg), void *arg) {
+    _band_render(x, y, w, h, bg, draw, arg);
+}
+
+void gfx_get_clip(gfx_rect_t *clip) {
+    if (_band_active) {
+        clip->x = _band_x;
+        clip->y = _band_y;
+        clip->w = _band_w;
+        clip->h = _band_h;
+    } else {
+        clip->x = 0;
+        clip->y = 0;
+        clip->w = _width;
+        clip->h = _height;
+    }
+}
+
 // Draw a single pixel
 void gfx_draw_pixel(int16_t x, int16_t y, uint16_t color) {
-    if (x < 0 || y < 0 || x >= _width || y >= _height) return;
-    display_draw_pixel(x, y, color);
+    if (_frame_push(GFX_OP_PIXEL, 0, color, x, y, 0, 0, 0, 0, NULL, NULL)) return;
+    _plot(x, y, color);
+    _plot_flush();
 }
 
 // Draw a 1-bit bitmap (each bit represents a pixel) with specified color for '1' bits
 void gfx_draw_bitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color) {
+    if (_frame_push(GFX_OP_BITMAP, 0, color, x, y, w, h, 0, 0, bitmap, NULL)) return;
     int16_t byteWidth = (w + 7) / 8; // Bytes per row
     uint8_t byte = 0;
 
@@ -283,14 +1088,16 @@ void gfx_draw_bitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int
                 byte = bitmap[j * byteWidth + i / 8];
             }
             if (byte & 0x01) {
-                gfx_draw_pixel(x + i, y + j, color);
+                _plot(x + i, y + j, color);
             }
         }
     }
+    _plot_flush();
 }
 
 // Draw a 1-bit bitmap with background color (for '0' bits)
 void gfx_draw_bitmap_bg(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color, uint16_t bg) {
+    if (_frame_push(GFX_OP_BITMAP_BG, 0, color, x, y, w, h, (int16_t)bg, 0, bitmap, NULL)) return;
     int16_t byteWidth = (w + 7) / 8; // Bytes per row
     uint8_t byte = 0;
 
@@ -302,42 +1109,48 @@ void gfx_draw_bitmap_bg(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w,
                 byte = bitmap[j * byteWidth + i / 8];
             }
             if (byte & 0x01) {
-                gfx_draw_pixel(x + i, y + j, color);
+                _plot(x + i, y + j, color);
             } else {
-                gfx_draw_pixel(x + i, y + j, bg);
+                _plot(x + i, y + j, bg);
             }
         }
     }
+    _plot_flush();
+}
+
+typedef struct {
+    int16_t x, y, w, h;
+    const uint16_t *bitmap;
+} gfx_rgb_bitmap_args_t;
+
+static void _draw_rgb_bitmap_band(void *arg) {
+    gfx_rgb_bitmap_args_t *a = (gfx_rgb_bitmap_args_t *)arg;
+    gfx_draw_rgb_bitmap(a->x, a->y, a->bitmap, a->w, a->h);
 }
 
 // Draw a 16-bit (RGB565) color bitmap
 void gfx_draw_rgb_bitmap(int16_t x, int16_t y, const uint16_t *bitmap, int16_t w, int16_t h) {
-    // Bounds checking
-    if (x >= _width || y >= _height || (x + w - 1) < 0 || (y + h - 1) < 0) return;
-
-    // Crop bitmap if it extends beyond display boundaries
-    int16_t x1 = x;
-    int16_t y1 = y;
-    int16_t x2 = x + w - 1;
-    int16_t y2 = y + h - 1;
-    
-    // Adjust coordinates if partially off-screen
-    if (x1 < 0) x1 = 0;
-    if (y1 < 0) y1 = 0;
-    if (x2 >= _width) x2 = _width - 1;
-    if (y2 >= _height) y2 = _height - 1;
-    
-    int16_t bw = x2 - x1 + 1; // Adjusted width
-    int16_t bh = y2 - y1 + 1; // Adjusted height
-    
-    // Calculate offsets into the bitmap
-    int16_t dx = x1 - x;
-    int16_t dy = y1 - y;
-    
-    // Draw visible portion of bitmap
-    for (int16_t j = 0; j < bh; j++) {
-        for (int16_t i = 0; i < bw; i++) {
-            gfx_draw_pixel(x1 + i, y1 + j, bitmap[(dy + j) * w + (dx + i)]);
+    if (_frame_push(GFX_OP_RGB_BITMAP, 0, 0, x, y, w, h, 0, 0, bitmap, NULL)) return;
+
+    // Straight to the panel the bitmap is copied through the band, one window per band
+    if (!_band_active) {
+        gfx_rgb_bitmap_args_t args = { x, y, w, h, bitmap };
+        _band_render(x, y, w, h, 0, _draw_rgb_bitmap_band, &args);
+        return;
+    }
+
+    // Clip to the band, which is already inside the screen
+    int16_t x1 = (x > _band_x) ? x : _band_x;
+    int16_t y1 = (y > _band_y) ? y : _band_y;
+    int16_t x2 = (x + w < _band_x + _band_w) ? x + w : _band_x + _band_w;
+    int16_t y2 = (y + h < _band_y + _band_h) ? y + h : _band_y + _band_h;
+    if (x1 >= x2 || y1 >= y2) return;
+
+    const uint16_t *src = &bitmap[(y1 - y) * w + (x1 - x)];
+    uint16_t *dst = &_band_buf[_band_cur][(y1 - _band_y) * _band_w + (x1 - _band_x)];
+    for (; y1 < y2; y1++, src += w, dst += _band_w) {
+        for (int16_t i = 0; i < x2 - x1; i++) {
+            dst[i] = DISPLAY_SWAP16(src[i]);
         }
     }
 }
@@ -345,20 +1158,43 @@ void gfx_draw_rgb_bitmap(int16_t x, int16_t y, const uint16_t *bitmap, int16_t w
 // Draw a 16-bit color bitmap with 1-bit mask
 // Where mask bit is 0, don't draw pixel
 void gfx_draw_rgb_bitmap_with_mask(int16_t x, int16_t y, const uint16_t *bitmap, const uint8_t *mask, int16_t w, int16_t h) {
+    if (_frame_push(GFX_OP_RGB_BITMAP_MASK, 0, 0, x, y, w, h, 0, 0, bitmap, mask)) return;
     int16_t byteWidth = (w + 7) / 8;
-    uint8_t byte = 0;
 
-    for (int16_t j = 0; j < h; j++) {
-        for (int16_t i = 0; i < w; i++) {
-            if (i & 7) {
-                byte >>= 1;
-            } else {
-                byte = mask[j * byteWidth + i / 8];
+    // Clip to the band or the screen
+    int16_t cx1 = _band_active ? _band_x : 0;
+    int16_t cy1 = _band_active ? _band_y : 0;
+    int16_t cx2 = _band_active ? _band_x + _band_w : _width;
+    int16_t cy2 = _band_active ? _band_y + _band_h : _height;
+    int16_t x1 = (x > cx1) ? x : cx1;
+    int16_t y1 = (y > cy1) ? y : cy1;
+    int16_t x2 = (x + w < cx2) ? x + w : cx2;
+    int16_t y2 = (y + h < cy2) ? y + h : cy2;
+    if (x1 >= x2 || y1 >= y2) return;
+
+    // Each row goes out as runs of set mask bits. Outside a band the idle
+    // band buffer holds the swapped run, _band_flush leaves it free.
+    for (int16_t j = y1 - y; j < y2 - y; j++) {
+        const uint8_t *m = &mask[j * byteWidth];
+        const uint16_t *src = &bitmap[j * w];
+        int16_t i = x1 - x;
+
+        while (i < x2 - x) {
+            if (!(m[i / 8] & (1 << (i & 7)))) {
+                i++;
+                continue;
             }
-            
-            // Draw pixel only if corresponding mask bit is 1
-            if (byte & 0x01) {
-                gfx_draw_pixel(x + i, y + j, bitmap[j * w + i]);
+
+            int16_t start = i;
+            while (i < x2 - x && (m[i / 8] & (1 << (i & 7)))) i++;
+
+            uint16_t *dst = _band_active ? &_band_buf[_band_cur][(y + j - _band_y) * _band_w + (x + start - _band_x)]
+                                         : _band_buf[_band_cur];
+            for (int16_t k = start; k < i; k++) {
+                *dst++ = DISPLAY_SWAP16(src[k]);
+            }
+            if (!_band_active) {
+                display_fill_window(x + start, y + j, x + i - 1, y + j, _band_buf[_band_cur], i - start);
             }
         }
     }
@@ -366,6 +1202,7 @@ void gfx_draw_rgb_bitmap_with_mask(int16_t x, int16_t y, const uint16_t *bitmap,
 
 // Draw a scaled bitmap
 void gfx_draw_scaled_bitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, int16_t scale, uint16_t color) {
+    if (_frame_push(GFX_OP_SCALED_BITMAP, 0, color, x, y, w, h, scale, 0, bitmap, NULL)) return;
     int16_t byteWidth = (w + 7) / 8;
     uint8_t byte = 0;
 
@@ -386,7 +1223,88 @@ void gfx_draw_scaled_bitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t
     }
 }
 
+// Decode one image row, pixels [skip, skip + count) go to dst in panel byte
+// order. Returns the start of the next row.
+static const uint8_t *_image_decode_row(const gfx_image_t *img, const uint8_t *p, uint16_t *dst,
+                                        int16_t skip, int16_t count) {
+    bool indexed = (img->format == GFX_IMAGE_RLE_INDEXED);
+    int16_t end = skip + count;
+
+    for (int16_t x = 0; x < img->width; ) {
+        uint8_t n = *p++;
+        int16_t len = (n & 0x7F) + 1;
+
+        if (n & 0x80) {
+            // Run of one color
+            uint16_t color = indexed ? img->palette[p[0]] : (uint16_t)((p[0] << 8) | p[1]);
+            p += indexed ? 1 : 2;
+            int16_t x1 = (x > skip) ? x : skip;
+            int16_t x2 = (x + len < end) ? x + len : end;
+            if (x1 < x2) {
+                uint16_t c = DISPLAY_SWAP16(color);
+                for (uint16_t *d = &dst[x1 - skip]; x1 < x2; x1++) *d++ = c;
+            }
+        } else if (x + len <= skip || x >= end) {
+            // Literal outside the wanted span
+            p += indexed ? len : len * 2;
+        } else {
+            for (int16_t i = 0; i < len; i++) {
+                uint16_t color = indexed ? img->palette[*p++] : (uint16_t)((p[0] << 8) | p[1]);
+                if (!indexed) p += 2;
+                if (x + i >= skip && x + i < end) dst[x + i - skip] = DISPLAY_SWAP16(color);
+            }
+        }
+        x += len;
+    }
+    return p;
+}
+
+typedef struct {
+    int16_t x, y;
+    const gfx_image_t *img;
+} gfx_image_args_t;
+
+static void _draw_image_band(void *arg) {
+    gfx_image_args_t *a = (gfx_image_args_t *)arg;
+    gfx_draw_image(a->x, a->y, a->img);
+}
+
+// Draw a run length coded image. Rows are decoded straight into the band, so
+// drawing to the panel needs no RAM beyond the band itself.
+void gfx_draw_image(int16_t x, int16_t y, const gfx_image_t *img) {
+    if (_frame_push(GFX_OP_IMAGE, 0, 0, x, y, img->width, img->height, 0, 0, img, NULL)) return;
+
+    if (!_band_active) {
+        gfx_image_args_t args = { x, y, img };
+        _band_render(x, y, img->width, img->height, 0, _draw_image_band, &args);
+        return;
+    }
+
+    int16_t x1 = (x > _band_x) ? x : _band_x;
+    int16_t y1 = (y > _band_y) ? y : _band_y;
+    int16_t x2 = (x + img->width < _band_x + _band_w) ? x + img->width : _band_x + _band_w;
+    int16_t y2 = (y + img->height < _band_y + _band_h) ? y + img->height : _band_y + _band_h;
+    if (x1 >= x2 || y1 >= y2) return;
+
+    // Rows can only be found by walking the ones above them
+    if (_image_img != img || _image_row > y1 - y) {
+        _image_img = img;
+        _image_data = img->data;
+        _image_row = 0;
+    }
+    for (; _image_row < y1 - y; _image_row++) {
+        _image_data = _image_decode_row(img, _image_data, NULL, 0, 0);
+    }
+
+    uint16_t *dst = &_band_buf[_band_cur][(y1 - _band_y) * _band_w + (x1 - _band_x)];
+    for (; y1 < y2; y1++, dst += _band_w) {
+        _image_data = _image_decode_row(img, _image_data, dst, x1 - x, x2 - x1);
+        _image_row++;
+    }
+}
+
 void gfx_draw_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+    if (_frame_push(GFX_OP_LINE, 0, color, x0, y0, x1, y1, 0, 0, NULL, NULL)) return;
     // Special cases for vertical and horizontal lines
     if (x0 == x1) {
         if (y0 > y1) _swap_int16(&y0, &y1);
@@ -421,9 +1339,9 @@ void gfx_draw_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t colo
 
         for (; x0 <= x1; x0++) {
             if (steep) {
-                gfx_draw_pixel(y0, x0, color);
+                _plot(y0, x0, color);
             } else {
-                gfx_draw_pixel(x0, y0, color);
+                _plot(x0, y0, color);
             }
             err -= dy;
             if (err < 0) {
@@ -431,61 +1349,20 @@ void gfx_draw_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t colo
                 err += dx;
             }
         }
+        _plot_flush();
     }
 }
 
 // Draw a vertical line (optimized)
 void gfx_draw_fast_v_line(int16_t x, int16_t y, int16_t h, uint16_t color) {
-    // Bounds check
-    if (x < 0 || x >= _width || y >= _height) return;
-    if (y < 0) {
-        h += y;
-        y = 0;
-    }
-    if ((y + h - 1) >= _height) h = _height - y;
-    if (h <= 0) return;
-    
-    // Prepare a buffer with the color
-    uint16_t *buffer = (uint16_t *)os_malloc(h * sizeof(uint16_t));
-    if (buffer) {
-        for (int i = 0; i < h; i++) {
-            buffer[i] = color;
-        }
-        display_fill_window(x, y, x, y + h - 1, buffer, h);
-        os_free(buffer);
-    } else {
-        // Fallback to pixel-by-pixel if malloc fails
-        for (int16_t i = 0; i < h; i++) {
-            gfx_draw_pixel(x, y + i, color);
-        }
-    }
+    if (_frame_push(GFX_OP_V_LINE, 0, color, x, y, h, 0, 0, 0, NULL, NULL)) return;
+    _sink_fill(x, y, 1, h, color);
 }
 
 // Draw a horizontal line (optimized)
 void gfx_draw_fast_h_line(int16_t x, int16_t y, int16_t w, uint16_t color) {
-    // Bounds check
-    if (y < 0 || y >= _height || x >= _width) return;
-    if (x < 0) {
-        w += x;
-        x = 0;
-    }
-    if ((x + w - 1) >= _width) w = _width - x;
-    if (w <= 0) return;
-    
-    // Prepare a buffer with the color
-    uint16_t *buffer = (uint16_t *)os_malloc(w * sizeof(uint16_t));
-    if (buffer) {
-        for (int i = 0; i < w; i++) {
-            buffer[i] = color;
-        }
-        display_fill_window(x, y, x + w - 1, y, buffer, w);
-        os_free(buffer);
-    } else {
-        // Fallback to pixel-by-pixel if malloc fails
-        for (int16_t i = 0; i < w; i++) {
-            gfx_draw_pixel(x + i, y, color);
-        }
-    }
+    if (_frame_push(GFX_OP_H_LINE, 0, color, x, y, w, 0, 0, 0, NULL, NULL)) return;
+    _sink_fill(x, y, w, 1, color);
 }
 
 // Draw a rectangle outline
@@ -498,38 +1375,13 @@ void gfx_draw_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
 
 // Fill a rectangle
 void gfx_fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
-    // Bounds check
-    if (x >= _width || y >= _height || w <= 0 || h <= 0) return;
-    if (x < 0) {
-        w += x;
-        x = 0;
-    }
-    if (y < 0) {
-        h += y;
-        y = 0;
-    }
-    if ((x + w - 1) >= _width) w = _width - x;
-    if ((y + h - 1) >= _height) h = _height - y;
-    
-    // Prepare a buffer with the color
-    uint32_t total_pixels = (uint32_t)w * h;
-    uint16_t *buffer = (uint16_t *)os_malloc(total_pixels * sizeof(uint16_t));
-    if (buffer) {
-        for (uint32_t i = 0; i < total_pixels; i++) {
-            buffer[i] = color;
-        }
-        display_fill_window(x, y, x + w - 1, y + h - 1, buffer, total_pixels);
-        os_free(buffer);
-    } else {
-        // Fallback to line-by-line if malloc fails
-        for (int16_t i = 0; i < h; i++) {
-            gfx_draw_fast_h_line(x, y + i, w, color);
-        }
-    }
+    if (_frame_push(GFX_OP_FILL_RECT, 0, color, x, y, w, h, 0, 0, NULL, NULL)) return;
+    _sink_fill(x, y, w, h, color);
 }
 
 // Draw a circle helper (for rounded rectangles and other partial circles)
 void gfx_draw_circle_helper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername, uint16_t color) {
+    if (_frame_push(GFX_OP_CIRCLE_HELPER, cornername, color, x0, y0, r, 0, 0, 0, NULL, NULL)) return;
     int16_t f = 1 - r;
     int16_t ddF_x = 1;
     int16_t ddF_y = -2 * r;
@@ -547,26 +1399,28 @@ void gfx_draw_circle_helper(int16_t x0, int16_t y0, int16_t r, uint8_t cornernam
         f += ddF_x;
         
         if (cornername & 0x4) {
-            gfx_draw_pixel(x0 + x, y0 + y, color);
-            gfx_draw_pixel(x0 + y, y0 + x, color);
+            _plot(x0 + x, y0 + y, color);
+            _plot(x0 + y, y0 + x, color);
         }
         if (cornername & 0x2) {
-            gfx_draw_pixel(x0 + x, y0 - y, color);
-            gfx_draw_pixel(x0 + y, y0 - x, color);
+            _plot(x0 + x, y0 - y, color);
+            _plot(x0 + y, y0 - x, color);
         }
         if (cornername & 0x8) {
-            gfx_draw_pixel(x0 - y, y0 + x, color);
-            gfx_draw_pixel(x0 - x, y0 + y, color);
+            _plot(x0 - y, y0 + x, color);
+            _plot(x0 - x, y0 + y, color);
         }
         if (cornername & 0x1) {
-            gfx_draw_pixel(x0 - y, y0 - x, color);
-            gfx_draw_pixel(x0 - x, y0 - y, color);
+            _plot(x0 - y, y0 - x, color);
+            _plot(x0 - x, y0 - y, color);
         }
     }
+    _plot_flush();
 }
 
 // Fill a circle helper (for filled rounded rectangles)
 void gfx_fill_circle_helper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername, int16_t delta, uint16_t color) {
+    if (_frame_push(GFX_OP_FILL_CIRCLE_HELPER, cornername, color, x0, y0, r, delta, 0, 0, NULL, NULL)) return;
     int16_t f = 1 - r;
     int16_t ddF_x = 1;
     int16_t ddF_y = -2 * r;
@@ -606,16 +1460,17 @@ void gfx_fill_circle_helper(int16_t x0, int16_t y0, int16_t r, uint8_t cornernam
 
 // Draw a circle
 void gfx_draw_circle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+    if (_frame_push(GFX_OP_CIRCLE, 0, color, x0, y0, r, 0, 0, 0, NULL, NULL)) return;
     int16_t f = 1 - r;
     int16_t ddF_x = 1;
     int16_t ddF_y = -2 * r;
     int16_t x = 0;
     int16_t y = r;
 
-    gfx_draw_pixel(x0, y0 + r, color);
-    gfx_draw_pixel(x0, y0 - r, color);
-    gfx_draw_pixel(x0 + r, y0, color);
-    gfx_draw_pixel(x0 - r, y0, color);
+    _plot(x0, y0 + r, color);
+    _plot(x0, y0 - r, color);
+    _plot(x0 + r, y0, color);
+    _plot(x0 - r, y0, color);
 
     while (x < y) {
         if (f >= 0) {
@@ -627,25 +1482,28 @@ void gfx_draw_circle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
         ddF_x += 2;
         f += ddF_x;
 
-        gfx_draw_pixel(x0 + x, y0 + y, color);
-        gfx_draw_pixel(x0 - x, y0 + y, color);
-        gfx_draw_pixel(x0 + x, y0 - y, color);
-        gfx_draw_pixel(x0 - x, y0 - y, color);
-        gfx_draw_pixel(x0 + y, y0 + x, color);
-        gfx_draw_pixel(x0 - y, y0 + x, color);
-        gfx_draw_pixel(x0 + y, y0 - x, color);
-        gfx_draw_pixel(x0 - y, y0 - x, color);
+        _plot(x0 + x, y0 + y, color);
+        _plot(x0 - x, y0 + y, color);
+        _plot(x0 + x, y0 - y, color);
+        _plot(x0 - x, y0 - y, color);
+        _plot(x0 + y, y0 + x, color);
+        _plot(x0 - y, y0 + x, color);
+        _plot(x0 + y, y0 - x, color);
+        _plot(x0 - y, y0 - x, color);
     }
+    _plot_flush();
 }
 
 // Fill a circle
 void gfx_fill_circle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+    if (_frame_push(GFX_OP_FILL_CIRCLE, 0, color, x0, y0, r, 0, 0, 0, NULL, NULL)) return;
     gfx_draw_fast_v_line(x0, y0 - r, 2 * r + 1, color);
     gfx_fill_circle_helper(x0, y0, r, 3, 0, color);
 }
 
 // Draw a rounded rectangle
 void gfx_draw_round_rect(int16_t x0, int16_t y0, int16_t w, int16_t h, int16_t radius, uint16_t color) {
+    if (_frame_push(GFX_OP_ROUND_RECT, 0, color, x0, y0, w, h, radius, 0, NULL, NULL)) return;
     // Check and constrain the radius size
     int16_t max_radius = ((w < h) ? w : h) / 2;
     if (radius > max_radius) radius = max_radius;
@@ -665,6 +1523,7 @@ void gfx_draw_round_rect(int16_t x0, int16_t y0, int16_t w, int16_t h, int16_t r
 
 // Fill a rounded rectangle
 void gfx_fill_round_rect(int16_t x0, int16_t y0, int16_t w, int16_t h, int16_t radius, uint16_t color) {
+    if (_frame_push(GFX_OP_FILL_ROUND_RECT, 0, color, x0, y0, w, h, radius, 0, NULL, NULL)) return;
     // Check and constrain the radius size
     int16_t max_radius = ((w < h) ? w : h) / 2;
     if (radius > max_radius) radius = max_radius;
@@ -686,6 +1545,7 @@ void gfx_draw_triangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x
 
 // Fill a triangle
 void gfx_fill_triangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color) {
+    if (_frame_push(GFX_OP_FILL_TRIANGLE, 0, color, x0, y0, x1, y1, x2, y2, NULL, NULL)) return;
     int16_t a, b, y, last;
 
     // Sort coordinates by Y order (y2 >= y1 >= y0)
@@ -750,7 +1610,11 @@ void gfx_fill_triangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x
 
 // Fill the entire screen with a color
 void gfx_fill_screen(uint16_t color) {
-    display_fill_screen(color);
+    if (_frame_recording) {
+        gfx_fill_rect(0, 0, _width, _height, color);
+        return;
+    }
+    _sink_fill(0, 0, _width, _height, color);
 }
 
 int16_t gfx_get_width(void) {
@@ -795,6 +1659,7 @@ void gfx_clear(void) {
 
 // Draw a dashed line
 void gfx_draw_dashed_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color, uint8_t dash_len, uint8_t gap_len) {
+    if (_frame_push(GFX_OP_DASHED_LINE, dash_len, color, x0, y0, x1, y1, gap_len, 0, NULL, NULL)) return;
     int16_t steep = abs(y1 - y0) > abs(x1 - x0);
     if (steep) {
         _swap_int16(&x0, &y0);
@@ -816,9 +1681,9 @@ void gfx_draw_dashed_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16
     for (int16_t x = x0, y = y0; x <= x1; x++) {
         if (draw) {
             if (steep) {
-                gfx_draw_pixel(y, x, color);
+                _plot(y, x, color);
             } else {
-                gfx_draw_pixel(x, y, color);
+                _plot(x, y, color);
             }
         }
 
@@ -835,53 +1700,434 @@ void gfx_draw_dashed_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16
             err += dx;
         }
     }
+    _plot_flush();
 }
 
-#define SEGMENT_DEG 2.0f
+// sin(0..90 degrees) in Q15
+static const int16_t _sin_q15_table[91] = {
+        0,   572,  1144,  1715,  2286,  2856,  3425,  3993,  4560,  5126,
+     5690,  6252,  6813,  7371,  7927,  8481,  9032,  9580, 10126, 10668,
+    11207, 11743, 12275, 12803, 13328, 13848, 14364, 14876, 15383, 15886,
+    16383, 16876, 17364, 17846, 18323, 18794, 19260, 19720, 20173, 20621,
+    21062, 21497, 21925, 22347, 22762, 23170, 23571, 23964, 24351, 24730,
+    25101, 25465, 25821, 26169, 26509, 26841, 27165, 27481, 27788, 28087,
+    28377, 28659, 28932, 29196, 29451, 29697, 29934, 30162, 30381, 30591,
+    30791, 30982, 31163, 31335, 31498, 31650, 31794, 31927, 32051, 32165,
+    32269, 32364, 32448, 32523, 32587, 32642, 32687, 32722, 32747, 32762,
+    32767,
+};
+
+int16_t gfx_sin_q15(int16_t deg) {
+    deg %= 360;
+    if (deg < 0) deg += 360;
+
+    if (deg <= 90)  return _sin_q15_table[deg];
+    if (deg <= 180) return _sin_q15_table[180 - deg];
+    if (deg <= 270) return -_sin_q15_table[deg - 180];
+    return -_sin_q15_table[360 - deg];
+}
 
-void gfx_draw_arc(int16_t x0, int16_t y0, int16_t r, int16_t start_angle, int16_t end_angle, 
-                uint8_t thickness, uint16_t color)
-{
-    // Normalize angles
+int16_t gfx_cos_q15(int16_t deg) {
+    return gfx_sin_q15(deg % 360 + 90);
+}
+
+static uint16_t _isqrt32(uint32_t v) {
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+static int32_t _floor_div(int32_t n, int32_t d) {
+    return (n >= 0) ? n / d : -((-n + d - 1) / d);
+}
+
+// x range of a row where a * x + b >= 0, empty when lo > hi
+static void _half_line(int32_t a, int32_t b, int32_t *lo, int32_t *hi) {
+    *lo = INT16_MIN;
+    *hi = INT16_MAX;
+    if (a > 0) {
+        *lo = -_floor_div(b, a);
+    } else if (a < 0) {
+        *hi = _floor_div(b, -a);
+    } else if (b < 0) {
+        *lo = 1;
+        *hi = 0;
+    }
+}
+
+// Angular range of an arc, as the edge directions in Q15
+typedef struct {
+    bool full;              // Whole turn
+    bool wide;              // More than half a turn
+    int32_t c0, s0;         // Start edge
+    int32_t c1, s1;         // End edge
+} gfx_sector_t;
+
+static void _sector_init(gfx_sector_t *sec, int16_t start_angle, int16_t end_angle) {
+    // Normalize angles, a span of 360 or more is the whole ring
+    int32_t span = (int32_t)end_angle - start_angle;
+    sec->full = (span >= 360);
     start_angle %= 360; if(start_angle < 0) start_angle += 360;
     end_angle   %= 360; if(end_angle   < 0) end_angle   += 360;
     if(end_angle < start_angle)       end_angle += 360;
-    if(end_angle - start_angle > 360) end_angle  = start_angle + 360;
+    sec->wide = (end_angle - start_angle > 180);
+
+    sec->c0 = gfx_cos_q15(start_angle);
+    sec->s0 = gfx_sin_q15(start_angle);
+    sec->c1 = gfx_cos_q15(end_angle);
+    sec->s1 = gfx_sin_q15(end_angle);
+}
+
+// Spans of row dy inside the sector, after the start edge and before the end
+// edge. Wider than a half turn it is the union of the two half planes
+// instead. Fills up to two [lo, hi] pairs and returns the number of values.
+static uint8_t _sector_row(const gfx_sector_t *sec, int32_t dy, int32_t *sect) {
+    int32_t lo0, hi0, lo1, hi1;
+    uint8_t n = 0;
+
+    if (sec->full) {
+        sect[n++] = INT16_MIN; sect[n++] = INT16_MAX;
+        return n;
+    }
+
+    _half_line(-sec->s0, sec->c0 * dy, &lo0, &hi0);
+    _half_line(sec->s1, -sec->c1 * dy, &lo1, &hi1);
+    if (!sec->wide) {
+        sect[n++] = (lo0 > lo1) ? lo0 : lo1;
+        sect[n++] = (hi0 < hi1) ? hi0 : hi1;
+        return n;
+    }
 
-    // Compute segment count and radians
-    float spanDeg = end_angle - start_angle;
-    int   N       = (int)roundf(spanDeg / SEGMENT_DEG);
-    if(N < 1) N = 1;
-    double spanRad = spanDeg * (M_PI/180.0);
-    double a0      = start_angle * (M_PI/180.0);
-    int16_t rin    = r - (thickness - 1);
-    if(rin < 0) rin = 0;
+    if (lo1 < lo0) {
+        int32_t t;
+        t = lo0; lo0 = lo1; lo1 = t;
+        t = hi0; hi0 = hi1; hi1 = t;
+    }
+    if (lo0 > hi0) {
+        sect[n++] = lo1; sect[n++] = hi1;
+    } else if (lo1 > hi1) {
+        sect[n++] = lo0; sect[n++] = hi0;
+    } else if (lo1 <= hi0 + 1) {
+        sect[n++] = lo0; sect[n++] = (hi0 > hi1) ? hi0 : hi1;
+    } else {
+        sect[n++] = lo0; sect[n++] = hi0;
+        sect[n++] = lo1; sect[n++] = hi1;
+    }
+    return n;
+}
+
+// Rows to walk for something spanning [y0 - r, y0 + r], clipped to the band or screen
+static void _row_range(int16_t y0, int16_t r, int16_t *ya, int16_t *yb) {
+    *ya = (_band_active && _band_y > 0) ? _band_y : 0;
+    *yb = _band_active ? _band_y + _band_h - 1 : _height - 1;
+    if (*ya < y0 - r) *ya = y0 - r;
+    if (*yb > y0 + r) *yb = y0 + r;
+}
 
-    // Preallocate point arrays on the stack (N is small, e.g. <=60)
-    int16_t xO[N+1], yO[N+1], xI[N+1], yI[N+1];
+// Draw a ring segment from start_angle to end_angle (degrees, clockwise from
+// 3 o'clock), thickness pixels wide inside radius r. Each row of the ring is
+// cut by the two edge half planes and sent as at most four spans.
+void gfx_draw_arc(int16_t x0, int16_t y0, int16_t r, int16_t start_angle, int16_t end_angle, 
+                uint8_t thickness, uint16_t color)
+{
+    if (_frame_push(GFX_OP_ARC, thickness, color, x0, y0, r, start_angle, end_angle, 0, NULL, NULL)) return;
+    if (r < 0) return;
+
+    gfx_sector_t sec;
+    _sector_init(&sec, start_angle, end_angle);
+
+    // Pixel centres inside r + 1/2 and outside rin - 1/2
+    int16_t rin = r - (thickness ? thickness - 1 : 0);
+    int32_t outer2 = (int32_t)r * r + r;
+    int32_t inner2 = (rin > 0) ? (int32_t)rin * rin - rin : -1;
+
+    int16_t ya, yb;
+    _row_range(y0, r, &ya, &yb);
+
+    for (int16_t y = ya; y <= yb; y++) {
+        int32_t dy = y - y0;
+        int32_t ring[4], sect[4];
+        uint8_t nring = 0, nsect;
+
+        // Ring spans
+        int32_t o2 = outer2 - dy * dy;
+        if (o2 < 0) continue;
+        int32_t xo = _isqrt32(o2);
+        int32_t i2 = inner2 - dy * dy;
+        if (i2 < 0) {
+            ring[nring++] = -xo; ring[nring++] = xo;
+        } else {
+            int32_t xi = _isqrt32(i2);
+            if (xi >= xo) continue;
+            ring[nring++] = -xo;    ring[nring++] = -xi - 1;
+            ring[nring++] = xi + 1; ring[nring++] = xo;
+        }
 
-    // Compute boundary points exactly
-    for(int i = 0; i <= N; i++) {
-        double ang = a0 + spanRad * i / N;
-        xO[i] = x0 + (int16_t)lround(r   * cos(ang));
-        yO[i] = y0 + (int16_t)lround(r   * sin(ang));
-        xI[i] = x0 + (int16_t)lround(rin * cos(ang));
-        yI[i] = y0 + (int16_t)lround(rin * sin(ang));
+        nsect = _sector_row(&sec, dy, sect);
+        for (uint8_t i = 0; i < nring; i += 2) {
+            for (uint8_t j = 0; j < nsect; j += 2) {
+                int32_t lo = (ring[i] > sect[j]) ? ring[i] : sect[j];
+                int32_t hi = (ring[i + 1] < sect[j + 1]) ? ring[i + 1] : sect[j + 1];
+                if (lo <= hi) {
+                    gfx_draw_fast_h_line(x0 + lo, y, hi - lo + 1, color);
+                }
+            }
+        }
     }
+}
+
+// Anti-aliasing. Coverage is 0..255, partly covered pixels are blended over
+// the band, or over _aa_bg when drawing straight to the panel. Fully covered
+// pixels are collected into runs and sent as horizontal lines.
+
+void gfx_set_aa_bg(uint16_t bg) {
+    _aa_bg = bg;
+}
+
+static uint16_t _blend565(uint16_t fg, uint16_t bg, uint8_t alpha) {
+    // Red and blue blend together in one word, green on its own
+    uint32_t rb = bg & 0xF81F;
+    rb += ((fg & 0xF81F) - rb) * (alpha >> 2) >> 6;
+    uint32_t g = bg & 0x07E0;
+    g += ((fg & 0x07E0) - g) * alpha >> 8;
+    return (rb & 0xF81F) | (g & 0x07E0);
+}
 
-    // Fill each trapezoid with two triangles
-    for(int i = 0; i < N; i++) {
-        gfx_fill_triangle(xO[i],  yO[i],
-                        xO[i+1],yO[i+1],
-                        xI[i],  yI[i], color);
-        gfx_fill_triangle(xI[i],  yI[i],
-                        xO[i+1],yO[i+1],
-                        xI[i+1],yI[i+1], color);
+static void _plot_aa(int16_t x, int16_t y, uint16_t color, uint8_t alpha) {
+    if (!alpha || x < 0 || y < 0 || x >= _width || y >= _height) return;
+    if (alpha == 255) {
+        gfx_draw_pixel(x, y, color);
+        return;
+    }
+    if (_band_active) {
+        if (x >= _band_x && x < _band_x + _band_w && y >= _band_y && y < _band_y + _band_h) {
+            uint16_t *p = &_band_buf[_band_cur][(y - _band_y) * _band_w + (x - _band_x)];
+            *p = DISPLAY_SWAP16(_blend565(color, DISPLAY_SWAP16(*p), alpha));
+        }
+        return;
     }
+    display_draw_pixel(x, y, _blend565(color, _aa_bg, alpha));
+}
+
+// Runs of fully covered pixels along a row
+typedef struct {
+    int16_t y;
+    int16_t x, len;
+    uint16_t color;
+} gfx_aa_run_t;
+
+static void _aa_run_flush(gfx_aa_run_t *run) {
+    if (run->len) {
+        gfx_draw_fast_h_line(run->x, run->y, run->len, run->color);
+        run->len = 0;
+    }
+}
+
+static void _aa_run_pixel(gfx_aa_run_t *run, int16_t x, uint8_t alpha) {
+    if (alpha == 255) {
+        if (run->len && run->x + run->len == x) {
+            run->len++;
+            return;
+        }
+        _aa_run_flush(run);
+        run->x = x;
+        run->len = 1;
+        return;
+    }
+    _aa_run_flush(run);
+    _plot_aa(x, run->y, run->color, alpha);
+}
+
+// Coverage of a pixel at distance d16 (1/16 px) from an edge at e16, inside when d16 < e16
+static uint8_t _aa_cover(int32_t d16, int32_t e16) {
+    int32_t c = (e16 + 8 - d16) * 16;
+    return (c <= 0) ? 0 : (c >= 255) ? 255 : c;
+}
+
+// Wu line, one pixel wide with the error split over the two nearest pixels
+void gfx_draw_line_aa(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+    if (_frame_push(GFX_OP_LINE_AA, 0, color, x0, y0, x1, y1, 0, 0, NULL, NULL)) return;
+
+    if (x0 == x1 || y0 == y1) {
+        gfx_draw_line(x0, y0, x1, y1, color);
+        return;
+    }
+
+    bool steep = abs(y1 - y0) > abs(x1 - x0);
+    if (steep) {
+        _swap_int16(&x0, &y0);
+        _swap_int16(&x1, &y1);
+    }
+    if (x0 > x1) {
+        _swap_int16(&x0, &x1);
+        _swap_int16(&y0, &y1);
+    }
+
+    int32_t grad = ((int32_t)(y1 - y0) << 16) / (x1 - x0);   // 16.16
+    int32_t yf = (int32_t)y0 << 16;
+
+    for (int16_t x = x0; x <= x1; x++, yf += grad) {
+        int16_t y = yf >> 16;
+        uint8_t frac = (yf >> 8) & 0xFF;
+        if (steep) {
+            _plot_aa(y, x, color, 255 - frac);
+            _plot_aa(y + 1, x, color, frac);
+        } else {
+            _plot_aa(x, y, color, 255 - frac);
+            _plot_aa(x, y + 1, color, frac);
+        }
+    }
+}
+
+// Line width pixels wide with round caps, coverage from the distance to the segment
+void gfx_draw_thick_line_aa(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t width, uint16_t color) {
+    if (_frame_push(GFX_OP_THICK_LINE_AA, width, color, x0, y0, x1, y1, 0, 0, NULL, NULL)) return;
+    if (width < 2) {
+        gfx_draw_line_aa(x0, y0, x1, y1, color);
+        return;
+    }
+
+    int32_t dx = x1 - x0, dy = y1 - y0;
+    int32_t len2 = dx * dx + dy * dy;
+    int32_t len16 = _isqrt32(len2 << 8);        // Length in 1/16 px
+    int32_t r16 = width * 8;                    // Radius in 1/16 px
+    int16_t m = width / 2 + 1;                  // Reach of any coverage
+
+    int16_t xa = ((x0 < x1) ? x0 : x1) - m, xb = ((x0 > x1) ? x0 : x1) + m;
+    int16_t ya, yb;
+    _row_range((y0 + y1) / 2, abs(dy) / 2 + m + 1, &ya, &yb);
+    if (xa < 0) xa = 0;
+    if (xb > _width - 1) xb = _width - 1;
+
+    for (int16_t y = ya; y <= yb; y++) {
+        int32_t py = y - y0;
+        int16_t sa = xa, sb = xb;
+
+        // Only the strip around the line can be covered
+        if (dy) {
+            int32_t xc = x0 + py * dx / dy;
+            int32_t hw = (int32_t)m * len16 / (abs(dy) * 16) + 1;
+            if (sa < xc - hw) sa = xc - hw;
+            if (sb > xc + hw) sb = xc + hw;
+        }
+
+        gfx_aa_run_t run = { y, 0, 0, color };
+        for (int16_t x = sa; x <= sb; x++) {
+            int32_t px = x - x0;
+            int32_t dot = px * dx + py * dy;
+            int32_t d16;            // Distance to the segment in 1/16 px
+
+            if (dot <= 0 || len2 == 0) {
+                d16 = _isqrt32((uint32_t)(px * px + py * py) << 8);
+            } else if (dot >= len2) {
+                int32_t qx = x - x1, qy = y - y1;
+                d16 = _isqrt32((uint32_t)(qx * qx + qy * qy) << 8);
+            } else {
+                d16 = abs(px * dy - py * dx) * 256 / len16;
+            }
+            _aa_run_pixel(&run, x, _aa_cover(d16, r16));
+        }
+        _aa_run_flush(&run);
+    }
+}
+
+// Ring between two radii in 1/16 px, both edges anti-aliased. ri16 < 0 fills
+// the disc. Pixels outside sec (if given) are skipped.
+static void _ring_aa(int16_t x0, int16_t y0, int32_t ro16, int32_t ri16, const gfx_sector_t *sec, uint16_t color) {
+    int16_t ya, yb;
+    _row_range(y0, (ro16 + 15) / 16 + 1, &ya, &yb);
+
+    int32_t reach = ro16 + 8;                                       // Any coverage inside
+    int32_t solid_o = (ro16 > 8) ? (ro16 - 8) * (ro16 - 8) : 0;     // Full coverage inside
+    int32_t solid_i = (ri16 < 0) ? -1 : (ri16 + 8) * (ri16 + 8);    // and outside
+    int32_t hole = (ri16 > 8) ? (ri16 - 8) * (ri16 - 8) : -1;       // No coverage inside
+
+    for (int16_t y = ya; y <= yb; y++) {
+        int32_t dy16 = (y - y0) * 16;
+        int32_t o2 = reach * reach - dy16 * dy16;
+        if (o2 < 0) continue;
+        int32_t xo = _isqrt32(o2) / 16;
+
+        int32_t sect[4];
+        uint8_t nsect = 2;
+        sect[0] = -xo;
+        sect[1] = xo;
+        if (sec) {
+            nsect = _sector_row(sec, y - y0, sect);
+        }
+
+        gfx_aa_run_t run = { y, 0, 0, color };
+        for (uint8_t j = 0; j < nsect; j += 2) {
+            int32_t lo = (sect[j] > -xo) ? sect[j] : -xo;
+            int32_t hi = (sect[j + 1] < xo) ? sect[j + 1] : xo;
+
+            for (int32_t dx = lo; dx <= hi; dx++) {
+                int32_t d2 = dx * dx * 256 + dy16 * dy16;
+                uint8_t alpha;
+
+                if (d2 <= hole) {
+                    // Skip the rest of the hole
+                    _aa_run_flush(&run);
+                    int32_t xi = _isqrt32(hole - dy16 * dy16) / 16;
+                    if (dx < 0 && -dx <= xi) dx = (xi < hi) ? xi : hi;
+                    continue;
+                }
+                if (d2 <= solid_o && d2 >= solid_i) {
+                    alpha = 255;
+                } else {
+                    int32_t d16 = _isqrt32(d2);
+                    alpha = _aa_cover(d16, ro16);
+                    if (ri16 >= 0) {
+                        uint8_t inner = _aa_cover(ri16 * 2 - d16, ri16);
+                        if (inner < alpha) alpha = inner;
+                    }
+                }
+                _aa_run_pixel(&run, x0 + dx, alpha);
+            }
+            _aa_run_flush(&run);
+        }
+    }
+}
+
+// One pixel wide anti-aliased circle
+void gfx_draw_circle_aa(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+    if (_frame_push(GFX_OP_CIRCLE_AA, 0, color, x0, y0, r, 0, 0, 0, NULL, NULL)) return;
+    if (r < 0) return;
+    _ring_aa(x0, y0, r * 16 + 8, r * 16 - 8, NULL, color);
+}
+
+void gfx_fill_circle_aa(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+    if (_frame_push(GFX_OP_FILL_CIRCLE_AA, 0, color, x0, y0, r, 0, 0, 0, NULL, NULL)) return;
+    if (r < 0) return;
+    _ring_aa(x0, y0, r * 16 + 8, -1, NULL, color);
+}
+
+// gfx_draw_arc with anti-aliased inner and outer edges
+void gfx_draw_arc_aa(int16_t x0, int16_t y0, int16_t r, int16_t start_angle, int16_t end_angle,
+                     uint8_t thickness, uint16_t color) {
+    if (_frame_push(GFX_OP_ARC_AA, thickness, color, x0, y0, r, start_angle, end_angle, 0, NULL, NULL)) return;
+    if (r < 0) return;
+
+    gfx_sector_t sec;
+    _sector_init(&sec, start_angle, end_angle);
+    int16_t rin = r - (thickness ? thickness - 1 : 0);
+    _ring_aa(x0, y0, r * 16 + 8, (rin > 0) ? rin * 16 - 8 : -1, &sec, color);
 }
 
 // Draw an ellipse
 void gfx_draw_ellipse(int16_t x0, int16_t y0, int16_t rx, int16_t ry, uint16_t color) {
+    if (_frame_push(GFX_OP_ELLIPSE, 0, color, x0, y0, rx, ry, 0, 0, NULL, NULL)) return;
     if (rx < 2) rx = 2;
     if (ry < 2) ry = 2;
     
@@ -894,10 +2140,10 @@ void gfx_draw_ellipse(int16_t x0, int16_t y0, int16_t rx, int16_t ry, uint16_t c
     
     // First set of points, y' > -1
     for (x = 0, y = ry, s = 2*ry2+rx2*(1-2*ry); ry2*x <= rx2*y; x++) {
-        gfx_draw_pixel(x0 + x, y0 + y, color);
-        gfx_draw_pixel(x0 - x, y0 + y, color);
-        gfx_draw_pixel(x0 + x, y0 - y, color);
-        gfx_draw_pixel(x0 - x, y0 - y, color);
+        _plot(x0 + x, y0 + y, color);
+        _plot(x0 - x, y0 + y, color);
+        _plot(x0 + x, y0 - y, color);
+        _plot(x0 - x, y0 - y, color);
         
         if (s >= 0) {
             s += fx2 * (1 - y);
@@ -908,10 +2154,10 @@ void gfx_draw_ellipse(int16_t x0, int16_t y0, int16_t rx, int16_t ry, uint16_t c
     
     // Second set of points, y' <= -1
     for (x = rx, y = 0, s = 2*rx2+ry2*(1-2*rx); rx2*y <= ry2*x; y++) {
-        gfx_draw_pixel(x0 + x, y0 + y, color);
-        gfx_draw_pixel(x0 - x, y0 + y, color);
-        gfx_draw_pixel(x0 + x, y0 - y, color);
-        gfx_draw_pixel(x0 - x, y0 - y, color);
+        _plot(x0 + x, y0 + y, color);
+        _plot(x0 - x, y0 + y, color);
+        _plot(x0 + x, y0 - y, color);
+        _plot(x0 - x, y0 - y, color);
         
         if (s >= 0) {
             s += fy2 * (1 - x);
@@ -919,10 +2165,12 @@ void gfx_draw_ellipse(int16_t x0, int16_t y0, int16_t rx, int16_t ry, uint16_t c
         }
         s += rx2 * ((4 * y) + 6);
     }
+    _plot_flush();
 }
 
 // Fill an ellipse
 void gfx_fill_ellipse(int16_t x0, int16_t y0, int16_t rx, int16_t ry, uint16_t color) {
+    if (_frame_push(GFX_OP_FILL_ELLIPSE, 0, color, x0, y0, rx, ry, 0, 0, NULL, NULL)) return;
     if (rx < 2) rx = 2;
     if (ry < 2) ry = 2;
     
@@ -969,59 +2217,232 @@ void gfx_draw_polygon(int16_t *points, uint8_t num_points, uint16_t color) {
     gfx_draw_line(points[(num_points-1)*2], points[(num_points-1)*2+1], points[0], points[1], color);
 }
 
+// Polygon edge, walked from its top row down. x on the current row is
+// x + e / dy exactly, stepping by q + r / dy per row.
+typedef struct {
+    int32_t x, e;
+    int32_t q, r, dy;
+    int16_t y0, y1;     // First row and the row below the last
+    int8_t dir;         // 1 when the edge runs down, -1 up
+} gfx_edge_t;
+
+static gfx_edge_t _poly_edges[GFX_POLYGON_MAX_EDGES];
+static uint8_t _poly_et[GFX_POLYGON_MAX_EDGES];    // Edges by first row
+static uint8_t _poly_ael[GFX_POLYGON_MAX_EDGES];   // Edges crossing the row, by x
+
+// First pixel centre on or right of the edge
+static inline int32_t _edge_x(const gfx_edge_t *e) {
+    return e->x + (e->e > 0);
+}
+
+// Pixels [x1, x2) of row y
+static void _polygon_span(int32_t x1, int32_t x2, int16_t y, uint16_t color) {
+    _sink_fill(x1, y, x2 - x1, 1, color);
+}
+
 // Fill a polygon
-// This uses a simple scanline algorithm
 void gfx_fill_polygon(int16_t *points, uint8_t num_points, uint16_t color) {
+    gfx_fill_polygon_rule(points, num_points, GFX_FILL_EVEN_ODD, color);
+}
+
+// Scanline fill with an edge table sorted by first row and an active edge
+// list kept in x order. Rows and pixels whose centres are inside are filled,
+// top and left edges included and bottom and right edges not, so polygons
+// sharing an edge do not overlap. Each edge costs one division, then rows
+// step in integers.
+void gfx_fill_polygon_rule(int16_t *points, uint8_t num_points, gfx_fill_rule_t rule, uint16_t color) {
     if (num_points < 3) return; // Need at least 3 points for a polygon
-    
-    // Find min and max Y values
-    int16_t min_y = points[1];
-    int16_t max_y = points[1];
-    
-    for (uint8_t i = 1; i < num_points; i++) {
-        if (points[i*2+1] < min_y) min_y = points[i*2+1];
-        if (points[i*2+1] > max_y) max_y = points[i*2+1];
+    if (_frame_push(GFX_OP_FILL_POLYGON, num_points, color, rule, 0, 0, 0, 0, 0, points, NULL)) return;
+
+    gfx_edge_t *edges = _poly_edges;
+    uint8_t *et = _poly_et, *ael = _poly_ael;
+    void *heap = NULL;
+    if (num_points > GFX_POLYGON_MAX_EDGES) {
+        heap = os_malloc(num_points * (sizeof(gfx_edge_t) + 2));
+        if (!heap) return; // Memory allocation failed
+        edges = heap;
+        et = (uint8_t *)&edges[num_points];
+        ael = et + num_points;
     }
-    
-    // Allocate space for nodes (intersections with scanline)
-    int16_t *nodes = (int16_t*)os_malloc(num_points * sizeof(int16_t));
-    if (!nodes) return; // Memory allocation failed
-    
-    // Process scanlines from min_y to max_y
-    for (int16_t y = min_y; y <= max_y; y++) {
-        // Build node list
-        int nodes_count = 0;
-        int16_t j = num_points - 1;
-        
-        for (int16_t i = 0; i < num_points; i++) {
-            if ((points[i*2+1] < y && points[j*2+1] >= y) || (points[j*2+1] < y && points[i*2+1] >= y)) {
-                nodes[nodes_count++] = points[i*2] + 
-                    (y - points[i*2+1]) * (points[j*2] - points[i*2]) / (points[j*2+1] - points[i*2+1]);
-            }
-            j = i;
+
+    int16_t ya = (_band_active && _band_y > 0) ? _band_y : 0;
+    int16_t yb = _band_active ? _band_y + _band_h : _height;
+    uint8_t n = 0;
+
+    // Edge table, horizontal edges and edges outside the rows are dropped
+    for (uint8_t i = 0; i < num_points; i++) {
+        uint8_t j = (i + 1 < num_points) ? i + 1 : 0;
+        int32_t xt = points[i*2], yt = points[i*2+1];
+        int32_t xe = points[j*2], ye = points[j*2+1];
+        int8_t dir = 1;
+        if (yt == ye) continue;
+        if (yt > ye) {
+            int32_t t;
+            t = xt; xt = xe; xe = t;
+            t = yt; yt = ye; ye = t;
+            dir = -1;
         }
-        
-        // Sort nodes (simple bubble sort for small lists)
-        for (int16_t i = 0; i < nodes_count - 1; i++) {
-            for (int16_t j = 0; j < nodes_count - 1 - i; j++) {
-                if (nodes[j] > nodes[j+1]) {
-                    int16_t temp = nodes[j];
-                    nodes[j] = nodes[j+1];
-                    nodes[j+1] = temp;
-                }
+        if (ye <= ya || yt >= yb) continue;
+
+        gfx_edge_t *e = &edges[n];
+        int32_t dx = xe - xt;
+        e->dy = ye - yt;
+        e->q = _floor_div(dx, e->dy);
+        e->r = dx - e->q * e->dy;
+        e->y0 = (yt < ya) ? ya : yt;
+        e->y1 = (ye > yb) ? yb : ye;
+        e->dir = dir;
+
+        // Start on the first row drawn, k * r < dy * dy fits 32 bits
+        uint32_t k = e->y0 - yt;
+        uint32_t kr = k * (uint32_t)e->r;
+        e->x = xt + (int32_t)k * e->q + (int32_t)(kr / e->dy);
+        e->e = kr % e->dy;
+
+        uint8_t m = n++;
+        for (; m > 0 && edges[et[m - 1]].y0 > e->y0; m--) et[m] = et[m - 1];
+        et[m] = n - 1;
+    }
+
+    uint8_t next = 0, active = 0;
+    int16_t y = n ? edges[et[0]].y0 : yb;
+    while (y < yb && (active || next < n)) {
+        // Drop finished edges, step the rest and take in new ones, keeping x order
+        uint8_t m = 0;
+        for (uint8_t i = 0; i < active; i++) {
+            if (edges[ael[i]].y1 > y) ael[m++] = ael[i];
+        }
+        active = m;
+        while (next < n && edges[et[next]].y0 == y) ael[active++] = et[next++];
+        for (uint8_t i = 1; i < active; i++) {
+            uint8_t a = ael[i];
+            int32_t x = _edge_x(&edges[a]);
+            uint8_t k = i;
+            for (; k > 0 && _edge_x(&edges[ael[k - 1]]) > x; k--) ael[k] = ael[k - 1];
+            ael[k] = a;
+        }
+
+        if (rule == GFX_FILL_NON_ZERO) {
+            int16_t wind = 0;
+            int32_t x1 = 0;
+            for (uint8_t i = 0; i < active; i++) {
+                const gfx_edge_t *e = &edges[ael[i]];
+                if (!wind) x1 = _edge_x(e);
+                wind += e->dir;
+                if (!wind) _polygon_span(x1, _edge_x(e), y, color);
+            }
+        } else {
+            for (uint8_t i = 0; i + 1 < active; i += 2) {
+                _polygon_span(_edge_x(&edges[ael[i]]), _edge_x(&edges[ael[i + 1]]), y, color);
             }
         }
-        
-        // Fill between node pairs
-        for (int16_t i = 0; i < nodes_count; i += 2) {
-            if (nodes[i] >= _width) break;
-            if (nodes[i+1] > 0) {
-                if (nodes[i] < 0) nodes[i] = 0;
-                if (nodes[i+1] > _width) nodes[i+1] = _width;
-                gfx_draw_fast_h_line(nodes[i], y, nodes[i+1] - nodes[i], color);
+
+        for (uint8_t i = 0; i < active; i++) {
+            gfx_edge_t *e = &edges[ael[i]];
+            e->x += e->q;
+            e->e += e->r;
+            if (e->e >= e->dy) {
+                e->e -= e->dy;
+                e->x++;
             }
         }
+        y++;
+        if (!active && next < n) y = edges[et[next]].y0;
     }
-    
-    os_free(nodes);
+
+    if (heap) os_free(heap);
+}
+
+// Scroll view. Content row r is kept in screen row _scroll_top + r mod h of
+// panel RAM and the panel is scrolled so the view shows [pos, pos + h).
+// Without hardware scrolling the view is repainted in place every step.
+typedef struct {
+    gfx_scroll_draw_t draw;
+    void *arg;
+    int16_t y, h, dy;
+} gfx_scroll_args_t;
+
+static gfx_scroll_draw_t _scroll_draw;
+static void *_scroll_arg;
+static int16_t _scroll_top, _scroll_h;
+static int16_t _scroll_pos;
+static uint16_t _scroll_bg;
+static bool _scroll_hw;
+
+static void _scroll_band(void *arg) {
+    const gfx_scroll_args_t *a = arg;
+    a->draw(a->y, a->h, a->dy, a->arg);
+}
+
+// Paint content rows [y, y + n) where they are kept, split where the ring wraps
+static void _scroll_paint(int16_t y, int16_t n) {
+    while (n > 0) {
+        int16_t slot = _scroll_hw ? y - _floor_div(y, _scroll_h) * _scroll_h : y - _scroll_pos;
+        int16_t rows = (_scroll_h - slot < n) ? _scroll_h - slot : n;
+        gfx_scroll_args_t a = { _scroll_draw, _scroll_arg, y, rows, _scroll_top + slot - y };
+
+        _band_render(0, _scroll_top + slot, _width, rows, _scroll_bg, _scroll_band, &a);
+        y += rows;
+        n -= rows;
+    }
+}
+
+bool gfx_scroll_view_begin(int16_t top, int16_t h, uint16_t bg, gfx_scroll_draw_t draw, void *arg) {
+    if (top < 0) {
+        h += top;
+        top = 0;
+    }
+    if (top + h > _height) h = _height - top;
+    if (h <= 0 || !draw) return false;
+
+    _scroll_draw = draw;
+    _scroll_arg = arg;
+    _scroll_top = top;
+    _scroll_h = h;
+    _scroll_pos = 0;
+    _scroll_bg = bg;
+    _scroll_hw = display_scroll_area(top, h);
+    if (_scroll_hw) display_scroll_to(0);
+
+    _scroll_paint(0, h);
+    return _scroll_hw;
+}
+
+// Move the view dy rows down the content. With hardware scrolling this is one
+// command plus the rows that came into view.
+void gfx_scroll_by(int16_t dy) {
+    int16_t old = _scroll_pos;
+
+    if (!_scroll_draw || !dy) return;
+
+    _scroll_pos += dy;
+    if (!_scroll_hw) {
+        _scroll_paint(_scroll_pos, _scroll_h);
+        return;
+    }
+
+    display_scroll_to(_scroll_pos - _floor_div(_scroll_pos, _scroll_h) * _scroll_h);
+    if (abs(dy) >= _scroll_h) {
+        _scroll_paint(_scroll_pos, _scroll_h);
+    } else if (dy > 0) {
+        _scroll_paint(old + _scroll_h, dy);
+    } else {
+        _scroll_paint(_scroll_pos, -dy);
+    }
+}
+
+int16_t gfx_scroll_get_pos(void) {
+    return _scroll_pos;
+}
+
+// Leave hardware scrolling, the view is repainted in screen order
+void gfx_scroll_view_end(void) {
+    if (!_scroll_draw) return;
+
+    if (_scroll_hw) {
+        display_scroll_off();
+        _scroll_hw = false;
+        _scroll_paint(_scroll_pos, _scroll_h);
+    }
+    _scroll_draw = NULL;
 }
@@ -28,8 +28,150 @@ typedef struct {
     uint8_t         yAdvance; // Newline distance (typically height)
 } GFXfont;
 
+// Run length coded images, made on the host with host/img2gfx.c. Each row is
+// a list of packets that never cross into the next row. A header byte n with
+// bit 7 set repeats the following pixel (n & 0x7F) + 1 times, otherwise n + 1
+// literal pixels follow. Pixels are RGB565 MSB first, or one byte palette
+// indexes for GFX_IMAGE_RLE_INDEXED.
+typedef enum {
+    GFX_IMAGE_RLE565,
+    GFX_IMAGE_RLE_INDEXED,
+} gfx_image_format_t;
+
+typedef struct {
+    const uint8_t  *data;    // Packed rows
+    const uint16_t *palette; // RGB565 colors, NULL for GFX_IMAGE_RLE565
+    uint16_t        width;
+    uint16_t        height;
+    uint8_t         format;  // gfx_image_format_t
+} gfx_image_t;
+
+// Rows in the RAM band used by GFX_RENDER_BAND, the band holds
+// DISPLAY_WIDTH * GFX_BAND_HEIGHT pixels (7.5 KB for 240x16)
+#ifndef GFX_BAND_HEIGHT
+#define GFX_BAND_HEIGHT 16
+#endif
+#define GFX_BAND_PIXELS (DISPLAY_WIDTH * GFX_BAND_HEIGHT)
+
+// Band buffers, with 2 the next band is drawn while the previous one is sent
+#ifndef GFX_BAND_BUFFERS
+#define GFX_BAND_BUFFERS 1
+#endif
+
+// Frame display list and dirty region limits. A command takes 24 bytes.
+#ifndef GFX_FRAME_MAX_CMDS
+#define GFX_FRAME_MAX_CMDS 192
+#endif
+#ifndef GFX_FRAME_MAX_RECTS
+#define GFX_FRAME_MAX_RECTS 16
+#endif
+
+// Glyph cache, opaque glyphs are kept as ready RGB565 blocks of up to
+// GFX_GLYPH_CACHE_SLOT_PIXELS pixels each. gfx_draw_char and gfx_print with a
+// background use it, for glyphs that don't overlap the one before them.
+// 0 slots disables it.
+#ifndef GFX_GLYPH_CACHE_SLOTS
+#define GFX_GLYPH_CACHE_SLOTS 0
+#endif
+#ifndef GFX_GLYPH_CACHE_SLOT_PIXELS
+#define GFX_GLYPH_CACHE_SLOT_PIXELS 512
+#endif
+
+// Points shapes collect before handing them to the span sink
+#ifndef GFX_POINT_BATCH
+#define GFX_POINT_BATCH 32
+#endif
+
+// Polygon edges kept in a static table, bigger polygons allocate one
+#ifndef GFX_POLYGON_MAX_EDGES
+#define GFX_POLYGON_MAX_EDGES 16
+#endif
+
+typedef struct {
+    int16_t x, y;
+    int16_t w, h;
+} gfx_rect_t;
+
+typedef struct {
+    int16_t x, y;
+} gfx_point_t;
+
+// Span sinks. Every shape hands its pixels to the current sink as
+// rectangles, a horizontal run when h is 1, and batches of single points,
+// clipped to the screen. The sink may reorder the points it is given.
+// Built in sinks draw to the panel or into the active band,
+// gfx_set_span_sink() sends everything to another one, for instance a
+// recorder on the host. NULL goes back to the built in sinks.
+typedef struct {
+    void (*fill)(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, void *arg);
+    void (*points)(gfx_point_t *pts, uint16_t n, uint16_t color, void *arg);
+    void *arg;
+} gfx_span_sink_t;
+
+// Which parts of a self intersecting polygon are inside
+typedef enum {
+    GFX_FILL_EVEN_ODD,  // Inside where a ray crosses an odd number of edges
+    GFX_FILL_NON_ZERO,  // Inside where the edges wind around a nonzero number of times
+} gfx_fill_rule_t;
+
+typedef enum {
+    GFX_RENDER_DIRECT,  // Every primitive is pushed straight to the panel
+    GFX_RENDER_BAND,    // Primitives draw into a RAM band flushed with one address window
+} gfx_render_mode_t;
+
 // Init
 void gfx_init(uint16_t width, uint16_t height, uint8_t rotation);
+void gfx_init_mode(uint16_t width, uint16_t height, uint8_t rotation, gfx_render_mode_t mode);
+gfx_render_mode_t gfx_get_render_mode(void);
+
+// Banded rendering, the scene is drawn once per band:
+//   gfx_band_begin(bg);
+//   do { ...draw... } while (gfx_band_next());
+// In GFX_RENDER_DIRECT mode the body runs once and draws straight to the panel.
+void gfx_band_begin(uint16_t bg);
+bool gfx_band_next(void);
+
+// Frames, primitives between gfx_begin_frame and gfx_end_frame are recorded
+// and their bounds added to a dirty region list. gfx_end_frame merges the
+// regions and rebuilds each one as bg plus every recorded primitive touching
+// it, so anything visible inside a dirty region must be redrawn in the frame.
+// Pointers passed to bitmap and polygon functions must stay valid until
+// gfx_end_frame. If the display list fills up the frame so far is flushed and
+// the rest of it is drawn directly.
+void gfx_begin_frame(uint16_t bg);
+void gfx_end_frame(void);
+void gfx_invalidate(int16_t x, int16_t y, int16_t w, int16_t h);
+
+// Dirty region lists like the one frames keep: the rectangle is clipped to
+// the screen and merged with every region it touches, or with the one that
+// grows least when all max are taken
+void gfx_region_add(gfx_rect_t *rects, uint8_t *count, uint8_t max, int16_t x, int16_t y, int16_t w, int16_t h);
+
+// Repaint a rectangle in RAM bands on bg, each band sent with one window.
+// draw runs once per band and anything outside the band is clipped. Not for
+// use inside a band loop or frame.
+void gfx_render_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t bg, void (*draw)(void *arg), void *arg);
+
+// Area drawing currently reaches, the active band or the screen
+void gfx_get_clip(gfx_rect_t *clip);
+
+// Span sink, see gfx_span_sink_t
+void gfx_set_span_sink(const gfx_span_sink_t *sink);
+const gfx_span_sink_t *gfx_builtin_span_sink(void);
+
+// Scroll view, rows [top, top + h) of the screen scroll in hardware and
+// only rows coming into view are drawn. draw paints content rows [y, y + h)
+// with content row r at screen row r + dy, anything outside them is clipped.
+// It runs in RAM bands on bg, so the view must not be used inside a band
+// loop or frame, and the rest of the screen must not be drawn over the view
+// while it is open. Returns false when the rotation can't scroll in
+// hardware, the view then repaints itself on every step.
+typedef void (*gfx_scroll_draw_t)(int16_t y, int16_t h, int16_t dy, void *arg);
+
+bool gfx_scroll_view_begin(int16_t top, int16_t h, uint16_t bg, gfx_scroll_draw_t draw, void *arg);
+void gfx_scroll_by(int16_t dy);
+int16_t gfx_scroll_get_pos(void);
+void gfx_scroll_view_end(void);
 
 // Display rotation and orientation functions
 void gfx_set_rotation(uint8_t rotation);
@@ -43,6 +185,7 @@ void gfx_draw_bitmap_bg(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w,
 void gfx_draw_rgb_bitmap(int16_t x, int16_t y, const uint16_t *bitmap, int16_t w, int16_t h);
 void gfx_draw_rgb_bitmap_with_mask(int16_t x, int16_t y, const uint16_t *bitmap, const uint8_t *mask, int16_t w, int16_t h);
 void gfx_draw_scaled_bitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, int16_t scale, uint16_t color);
+void gfx_draw_image(int16_t x, int16_t y, const gfx_image_t *img);
 
 // Basic drawing functions
 void gfx_draw_pixel(int16_t x, int16_t y, uint16_t color);
@@ -67,6 +210,20 @@ void gfx_fill_circle_helper(int16_t x0, int16_t y0, int16_t r, uint8_t cornernam
 void gfx_draw_arc(int16_t x0, int16_t y0, int16_t r, int16_t start_angle, int16_t end_angle, 
                 uint8_t thickness, uint16_t color);
 
+// Anti-aliased drawing, edge pixels are blended over the band or, when
+// drawing straight to the panel, over the color set with gfx_set_aa_bg
+void gfx_set_aa_bg(uint16_t bg);
+void gfx_draw_line_aa(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+void gfx_draw_thick_line_aa(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t width, uint16_t color);
+void gfx_draw_circle_aa(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+void gfx_fill_circle_aa(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+void gfx_draw_arc_aa(int16_t x0, int16_t y0, int16_t r, int16_t start_angle, int16_t end_angle,
+                     uint8_t thickness, uint16_t color);
+
+// Sine and cosine of whole degrees in Q15, from a table
+int16_t gfx_sin_q15(int16_t deg);
+int16_t gfx_cos_q15(int16_t deg);
+
 // Ellipse functions
 void gfx_draw_ellipse(int16_t x0, int16_t y0, int16_t rx, int16_t ry, uint16_t color);
 void gfx_fill_ellipse(int16_t x0, int16_t y0, int16_t rx, int16_t ry, uint16_t color);
@@ -78,6 +235,7 @@ void gfx_fill_triangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x
 // Polygon functions
 void gfx_draw_polygon(int16_t *points, uint8_t num_points, uint16_t color);
 void gfx_fill_polygon(int16_t *points, uint8_t num_points, uint16_t color);
+void gfx_fill_polygon_rule(int16_t *points, uint8_t num_points, gfx_fill_rule_t rule, uint16_t color);
 
 // Fill the screen
 void gfx_fill_screen(uint16_t color);
@@ -103,4 +261,8 @@ void gfx_draw_text(int16_t x, int16_t y, const char *str, uint16_t color);
 void gfx_write_char(char c);
 int16_t gfx_draw_char(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
 
+// Glyph cache
+void gfx_glyph_cache_clear(void);
+void gfx_glyph_cache_stats(uint32_t *hits, uint32_t *misses);
+
 #endif // GFX_H
\ No newline at end of file
@@ -19,7 +19,10 @@
 #include "driver_flash.h"
 #include "flash_usage_config.h"
 #include "app/app.h"
+#include "display/display_pm.h"
 #include "utils/utils.h"
+#include "utils/frame_sched.h"
+#include "bench/gfx_bench.h"
 
 extern uint8_t master_link_conidx;
 
@@ -79,6 +82,15 @@ void user_custom_parameters(void)
     retry_handshake();
 }
 
+__attribute__((section("ram_code"))) void pmu_gpio_isr_ram(void)
+{
+    uint32_t gpio_value = ool_read32(PMU_REG_GPIOA_V);
+
+    display_pm_activity();
+    frame_sched_trigger();
+    ool_write32(PMU_REG_PORTA_LAST, gpio_value);
+}
+
 /*********************************************************************
  * @fn      user_entry_before_sleep_imp
  *
@@ -94,7 +106,9 @@ void user_custom_parameters(void)
  */
 __attribute__((section("ram_code"))) void user_entry_before_sleep_imp(void)
 {
-    co_printf("befor_sleep\r\n");
+    /* the button wakes the system up, the PMU watches it while asleep */
+    pmu_port_wakeup_func_set(1 << (BUTTON_GPIO_PIN_NAME * 8 + BUTTON_GPIO_PIN_NUM));
+    display_pm_before_sleep();
 }
 
 /*********************************************************************
@@ -133,6 +147,9 @@ __attribute__((section("ram_code"))) void user_entry_after_sleep_imp(void)
 
     co_printf("after_sleep\r\n");
 
+    pmu_set_pin_to_CPU(BUTTON_GPIO_PIN_NAME, 1 << BUTTON_GPIO_PIN_NUM);
+    display_pm_after_sleep();
+
     NVIC_EnableIRQ(PMU_IRQn);
 }
 
@@ -202,7 +219,9 @@ void user_entry_before_ble_init(void)
 void user_entry_after_ble_init(void)
 {
     device_init();
+#if GFX_BENCH
+    gfx_bench_run();
+#endif
+    /* frames run from the scheduler's task, the system idles in between */
     app_init();
-
-    while(1) app_update();
 }
\ No newline at end of file
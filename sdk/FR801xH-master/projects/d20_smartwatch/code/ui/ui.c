@@ -0,0 +1,426 @@
+#include "ui/ui.h"
+#include <string.h>
+
+static ui_widget_t _pool[UI_MAX_WIDGETS];
+static ui_widget_t *_root;
+static gfx_rect_t _damage[UI_MAX_DAMAGE];
+static uint8_t _damage_count;
+
+static bool _overlap(int16_t x, int16_t y, int16_t w, int16_t h, const gfx_rect_t *r) {
+    return x < r->x + r->w && x + w > r->x && y < r->y + r->h && y + h > r->y;
+}
+
+// Top left corner on screen
+static void _screen_pos(const ui_widget_t *w, int16_t *x, int16_t *y) {
+    *x = 0;
+    *y = 0;
+    for (; w; w = w->parent) {
+        *x += w->x;
+        *y += w->y;
+    }
+}
+
+static bool _shown(const ui_widget_t *w) {
+    for (; w; w = w->parent) {
+        if (!w->visible) return false;
+    }
+    return true;
+}
+
+static void _damage_area(const ui_widget_t *w, int16_t x, int16_t y, int16_t width, int16_t height) {
+    if (!_shown(w)) return;
+
+    int16_t sx, sy;
+    _screen_pos(w, &sx, &sy);
+    gfx_region_add(_damage, &_damage_count, UI_MAX_DAMAGE, sx + x, sy + y, width, height);
+}
+
+static void _damage_widget(const ui_widget_t *w) {
+    _damage_area(w, 0, 0, w->w, w->h);
+}
+
+// The widget and everything under it, children may reach outside their parent
+static void _damage_tree(const ui_widget_t *w) {
+    if (!w->visible) return;
+
+    _damage_widget(w);
+    for (const ui_widget_t *c = w->child; c; c = c->next) {
+        _damage_tree(c);
+    }
+}
+
+static ui_widget_t *_alloc(ui_type_t type, int16_t x, int16_t y, int16_t w, int16_t h) {
+    for (uint8_t i = 0; i < UI_MAX_WIDGETS; i++) {
+        ui_widget_t *n = &_pool[i];
+        if (n->used) continue;
+
+        memset(n, 0, sizeof(*n));
+        n->used = true;
+        n->visible = true;
+        n->type = type;
+        n->x = x;
+        n->y = y;
+        n->w = w;
+        n->h = h;
+        return n;
+    }
+    return NULL;
+}
+
+static void _unlink(ui_widget_t *w) {
+    if (!w->parent) return;
+
+    ui_widget_t **p = &w->parent->child;
+    while (*p != w) p = &(*p)->next;
+    *p = w->next;
+    w->next = NULL;
+}
+
+// Keep siblings sorted by z, a new one goes on top of its equals
+static void _link(ui_widget_t *parent, ui_widget_t *w) {
+    ui_widget_t **p = &parent->child;
+    while (*p && (*p)->z <= w->z) p = &(*p)->next;
+    w->next = *p;
+    *p = w;
+    w->parent = parent;
+}
+
+static ui_widget_t *_add(ui_widget_t *parent, ui_type_t type, int16_t x, int16_t y, int16_t w, int16_t h) {
+    ui_widget_t *n = _alloc(type, x, y, w, h);
+    if (!n) return NULL;
+
+    _link(parent ? parent : _root, n);
+    return n;
+}
+
+// Text bounds as the glyph boxes of the font, relative to the origin
+static void _label_bounds(ui_widget_t *w) {
+    const GFXfont *font = w->label.font;
+    int16_t x = 0, x1 = INT16_MAX, y1 = INT16_MAX, x2 = INT16_MIN, y2 = INT16_MIN;
+
+    for (const char *s = w->label.text; *s; s++) {
+        uint8_t c = (uint8_t)*s;
+        if (c < font->first || c > font->last) c = '?';
+        const GFXglyph *g = &font->glyph[c - font->first];
+        if (g->width && g->height) {
+            if (x + g->xOffset < x1) x1 = x + g->xOffset;
+            if (g->yOffset < y1) y1 = g->yOffset;
+            if (x + g->xOffset + g->width > x2) x2 = x + g->xOffset + g->width;
+            if (g->yOffset + g->height > y2) y2 = g->yOffset + g->height;
+        }
+        x += g->xAdvance;
+    }
+
+    // The origin stays put, the bounds move around it
+    int16_t ox = w->x + w->label.ox, oy = w->y + w->label.oy;
+    if (x1 > x2) {
+        x1 = x2 = 0;
+        y1 = y2 = 0;
+    }
+    w->label.ox = -x1;
+    w->label.oy = -y1;
+    w->x = ox + x1;
+    w->y = oy + y1;
+    w->w = x2 - x1;
+    w->h = y2 - y1;
+}
+
+static void _draw_label(const ui_widget_t *w, int16_t x, int16_t y) {
+    const GFXfont *prev = gfx_get_current_font();
+
+    // Drawn glyph by glyph, the text color and cursor stay untouched
+    x += w->label.ox;
+    y += w->label.oy;
+    gfx_set_font(w->label.font);
+    for (const char *s = w->label.text; *s; s++) {
+        x += gfx_draw_char(x, y, (uint8_t)*s, w->color, w->color, 1);
+    }
+    gfx_set_font(prev);
+}
+
+// Angle the value reaches, in degrees
+static int16_t _arc_end(const ui_widget_t *w, uint16_t value) {
+    return w->arc.start + (int32_t)w->arc.sweep * value / w->arc.max;
+}
+
+// Part of the ring between angles a0 and a1, relative to the widget
+static void _arc_damage(const ui_widget_t *w, int16_t a0, int16_t a1) {
+    if (a0 > a1) {
+        int16_t t = a0;
+        a0 = a1;
+        a1 = t;
+    }
+
+    int16_t c = w->arc.r + 1;
+    int16_t radius[2] = { w->arc.r, w->arc.r - w->arc.thickness };
+    int16_t x1 = INT16_MAX, y1 = INT16_MAX, x2 = INT16_MIN, y2 = INT16_MIN;
+
+    // Both ends at either radius, then the outer edge where it crosses an axis
+    int16_t a;
+    for (uint8_t i = 0; i < 4; i++) {
+        a = (i < 2) ? a0 : a1;
+        int16_t px = ((int32_t)radius[i & 1] * gfx_cos_q15(a)) >> 15;
+        int16_t py = ((int32_t)radius[i & 1] * gfx_sin_q15(a)) >> 15;
+        if (px < x1) x1 = px;
+        if (px > x2) x2 = px;
+        if (py < y1) y1 = py;
+        if (py > y2) y2 = py;
+    }
+    a = a0 - ((a0 % 90) + 90) % 90;
+    if (a < a0) a += 90;
+    for (; a <= a1; a += 90) {
+        int16_t q = ((a / 90) % 4 + 4) % 4;
+        if (q == 0) x2 = w->arc.r;
+        if (q == 1) y2 = w->arc.r;
+        if (q == 2) x1 = -w->arc.r;
+        if (q == 3) y1 = -w->arc.r;
+    }
+
+    // Room for rounding and the anti-aliased edge
+    _damage_area(w, c + x1 - 2, c + y1 - 2, x2 - x1 + 5, y2 - y1 + 5);
+}
+
+static void _draw_widget(const ui_widget_t *w, int16_t x, int16_t y) {
+    switch (w->type) {
+    case UI_CONTAINER:
+        if (w->opaque) gfx_fill_rect(x, y, w->w, w->h, w->bg);
+        break;
+    case UI_LABEL:
+        if (w->opaque) gfx_fill_rect(x, y, w->w, w->h, w->bg);
+        _draw_label(w, x, y);
+        break;
+    case UI_IMAGE:
+        gfx_draw_image(x, y, w->image);
+        break;
+    case UI_ARC: {
+        int16_t cx = x + w->arc.r + 1, cy = y + w->arc.r + 1;
+        int16_t end = _arc_end(w, w->arc.value);
+        if (w->arc.value < w->arc.max) {
+            gfx_draw_arc_aa(cx, cy, w->arc.r, end, w->arc.start + w->arc.sweep, w->arc.thickness, w->bg);
+        }
+        if (w->arc.value) {
+            gfx_draw_arc_aa(cx, cy, w->arc.r, w->arc.start, end, w->arc.thickness, w->color);
+        }
+        break;
+    }
+    case UI_PROGRESS: {
+        int16_t fw = (int32_t)w->w * w->progress.value / w->progress.max;
+        gfx_fill_rect(x, y, fw, w->h, w->color);
+        gfx_fill_rect(x + fw, y, w->w - fw, w->h, w->bg);
+        break;
+    }
+    case UI_CANVAS:
+        w->canvas.draw((ui_widget_t *)w, x, y, w->canvas.arg);
+        break;
+    }
+}
+
+static void _draw_tree(const ui_widget_t *w, int16_t x, int16_t y, const gfx_rect_t *clip) {
+    if (!w->visible) return;
+
+    x += w->x;
+    y += w->y;
+    if (_overlap(x, y, w->w, w->h, clip)) _draw_widget(w, x, y);
+    for (const ui_widget_t *c = w->child; c; c = c->next) {
+        _draw_tree(c, x, y, clip);
+    }
+}
+
+static void _draw_band(void *arg) {
+    gfx_rect_t clip;
+
+    (void)arg;
+
+    gfx_get_clip(&clip);
+    _draw_tree(_root, 0, 0, &clip);
+}
+
+void ui_init(uint16_t bg) {
+    memset(_pool, 0, sizeof(_pool));
+    _damage_count = 0;
+
+    _root = _alloc(UI_CONTAINER, 0, 0, gfx_get_width(), gfx_get_height());
+    _root->opaque = true;
+    _root->bg = bg;
+    _damage_widget(_root);
+}
+
+ui_widget_t *ui_root(void) {
+    return _root;
+}
+
+ui_widget_t *ui_container(ui_widget_t *parent, int16_t x, int16_t y, int16_t w, int16_t h) {
+    return _add(parent, UI_CONTAINER, x, y, w, h);
+}
+
+ui_widget_t *ui_label(ui_widget_t *parent, int16_t x, int16_t y, const GFXfont *font, uint16_t color) {
+    ui_widget_t *n = _add(parent, UI_LABEL, x, y, 0, 0);
+    if (!n) return NULL;
+
+    n->label.font = font;
+    n->color = color;
+    return n;
+}
+
+ui_widget_t *ui_image(ui_widget_t *parent, int16_t x, int16_t y, const gfx_image_t *img) {
+    ui_widget_t *n = _add(parent, UI_IMAGE, x, y, img->width, img->height);
+    if (!n) return NULL;
+
+    n->image = img;
+    _damage_widget(n);
+    return n;
+}
+
+ui_widget_t *ui_arc(ui_widget_t *parent, int16_t cx, int16_t cy, int16_t r, uint8_t thickness,
+                    int16_t start, int16_t sweep, uint16_t max, uint16_t color, uint16_t track) {
+    ui_widget_t *n = _add(parent, UI_ARC, cx - r - 1, cy - r - 1, 2 * r + 3, 2 * r + 3);
+    if (!n) return NULL;
+
+    n->arc.r = r;
+    n->arc.thickness = thickness;
+    if (sweep < 0) sweep = 0;
+    if (sweep > 360) sweep = 360;
+    n->arc.start = start;
+    n->arc.sweep = sweep;
+    n->arc.max = max ? max : 1;
+    n->color = color;
+    n->bg = track;
+    _arc_damage(n, start, start + sweep);
+    return n;
+}
+
+ui_widget_t *ui_progress(ui_widget_t *parent, int16_t x, int16_t y, int16_t w, int16_t h,
+                         uint16_t max, uint16_t color, uint16_t track) {
+    ui_widget_t *n = _add(parent, UI_PROGRESS, x, y, w, h);
+    if (!n) return NULL;
+
+    n->progress.max = max ? max : 1;
+    n->color = color;
+    n->bg = track;
+    _damage_widget(n);
+    return n;
+}
+
+ui_widget_t *ui_canvas(ui_widget_t *parent, int16_t x, int16_t y, int16_t w, int16_t h, ui_draw_t draw, void *arg) {
+    ui_widget_t *n = _add(parent, UI_CANVAS, x, y, w, h);
+    if (!n) return NULL;
+
+    n->canvas.draw = draw;
+    n->canvas.arg = arg;
+    _damage_widget(n);
+    return n;
+}
+
+static void _free_tree(ui_widget_t *w) {
+    while (w->child) {
+        ui_widget_t *c = w->child;
+        w->child = c->next;
+        _free_tree(c);
+    }
+    w->used = false;
+}
+
+void ui_delete(ui_widget_t *w) {
+    if (!w || w == _root) return;
+
+    _damage_tree(w);
+    _unlink(w);
+    _free_tree(w);
+}
+
+void ui_set_text(ui_widget_t *w, const char *text) {
+    if (w->type != UI_LABEL || !strncmp(w->label.text, text, UI_LABEL_LEN - 1)) return;
+
+    _damage_widget(w);
+    strncpy(w->label.text, text, UI_LABEL_LEN - 1);
+    _label_bounds(w);
+    _damage_widget(w);
+}
+
+void ui_set_value(ui_widget_t *w, uint16_t value) {
+    if (w->type == UI_ARC) {
+        if (value > w->arc.max) value = w->arc.max;
+        if (value == w->arc.value) return;
+        _arc_damage(w, _arc_end(w, w->arc.value), _arc_end(w, value));
+        w->arc.value = value;
+    } else if (w->type == UI_PROGRESS) {
+        if (value > w->progress.max) value = w->progress.max;
+        if (value == w->progress.value) return;
+
+        // Only the strip between the old and the new end changes
+        int16_t a = (int32_t)w->w * w->progress.value / w->progress.max;
+        int16_t b = (int32_t)w->w * value / w->progress.max;
+        _damage_area(w, (a < b) ? a : b, 0, abs(b - a), w->h);
+        w->progress.value = value;
+    }
+}
+
+void ui_set_color(ui_widget_t *w, uint16_t color) {
+    if (w->color == color) return;
+
+    w->color = color;
+    _damage_widget(w);
+}
+
+void ui_set_bg(ui_widget_t *w, uint16_t bg) {
+    if (w->bg == bg && (w->opaque || (w->type != UI_CONTAINER && w->type != UI_LABEL))) return;
+
+    w->bg = bg;
+    w->opaque = true;
+    _damage_widget(w);
+}
+
+void ui_set_visible(ui_widget_t *w, bool visible) {
+    if (w->visible == visible) return;
+
+    // Damage while shown, either before hiding or after showing
+    if (!visible) _damage_tree(w);
+    w->visible = visible;
+    if (visible) _damage_tree(w);
+}
+
+void ui_set_z(ui_widget_t *w, int8_t z) {
+    if (w->z == z || !w->parent) return;
+
+    ui_widget_t *parent = w->parent;
+    _unlink(w);
+    w->z = z;
+    _link(parent, w);
+    _damage_tree(w);
+}
+
+void ui_move(ui_widget_t *w, int16_t x, int16_t y) {
+    int16_t dx = x - w->x, dy = y - w->y;
+    if (w->type == UI_LABEL) {
+        // Labels are placed by their text origin
+        dx = x - (w->x + w->label.ox);
+        dy = y - (w->y + w->label.oy);
+    }
+    if (!dx && !dy) return;
+
+    _damage_tree(w);
+    w->x += dx;
+    w->y += dy;
+    _damage_tree(w);
+}
+
+void ui_invalidate(ui_widget_t *w) {
+    _damage_tree(w);
+}
+
+void ui_invalidate_rect(int16_t x, int16_t y, int16_t w, int16_t h) {
+    gfx_region_add(_damage, &_damage_count, UI_MAX_DAMAGE, x, y, w, h);
+}
+
+void ui_render(void) {
+    // Regions are taken off the list first, drawing may damage again
+    gfx_rect_t damage[UI_MAX_DAMAGE];
+    uint8_t count = _damage_count;
+
+    memcpy(damage, _damage, count * sizeof(gfx_rect_t));
+    _damage_count = 0;
+
+    for (uint8_t i = 0; i < count; i++) {
+        gfx_render_rect(damage[i].x, damage[i].y, damage[i].w, damage[i].h, _root->bg, _draw_band, NULL);
+    }
+}
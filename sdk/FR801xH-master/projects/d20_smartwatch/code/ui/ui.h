@@ -0,0 +1,112 @@
+#ifndef UI_H
+#define UI_H
+
+#include "display/gfx.h"
+
+// Retained widgets over gfx. Widgets come from a static pool and hang in a
+// tree under a full screen root, children draw over their parent and
+// siblings in z order. Positions are relative to the parent and children
+// aren't clipped to it. Changing a widget damages the area it covered and
+// the area it covers now, ui_render repaints just the damaged regions in RAM
+// bands and only draws the widgets overlapping each band.
+
+#ifndef UI_MAX_WIDGETS
+#define UI_MAX_WIDGETS 16
+#endif
+
+// Damaged regions kept apart, more are merged
+#ifndef UI_MAX_DAMAGE
+#define UI_MAX_DAMAGE 8
+#endif
+
+// Label text is copied into the widget
+#ifndef UI_LABEL_LEN
+#define UI_LABEL_LEN 16
+#endif
+
+typedef enum {
+    UI_CONTAINER,
+    UI_LABEL,
+    UI_IMAGE,
+    UI_ARC,
+    UI_PROGRESS,
+    UI_CANVAS,
+} ui_type_t;
+
+typedef struct ui_widget ui_widget_t;
+
+// Draws a canvas with its top left corner at x, y on screen
+typedef void (*ui_draw_t)(ui_widget_t *w, int16_t x, int16_t y, void *arg);
+
+struct ui_widget {
+    uint8_t type;
+    int8_t z;
+    bool used;
+    bool visible;
+    bool opaque;                // Container and label fill bg first
+    ui_widget_t *parent;
+    ui_widget_t *child;         // Lowest z first
+    ui_widget_t *next;
+    int16_t x, y, w, h;         // Bounds, relative to the parent
+    uint16_t color;
+    uint16_t bg;                // Also the track of arcs and progress bars
+    union {
+        struct {
+            const GFXfont *font;
+            int16_t ox, oy;     // Text origin inside the bounds
+            char text[UI_LABEL_LEN];
+        } label;
+        const gfx_image_t *image;
+        struct {
+            int16_t r;
+            int16_t start, sweep;
+            uint8_t thickness;
+            uint16_t value, max;
+        } arc;
+        struct {
+            uint16_t value, max;
+        } progress;
+        struct {
+            ui_draw_t draw;
+            void *arg;
+        } canvas;
+    };
+};
+
+// Empties the pool and damages the whole screen, the root is painted bg
+void ui_init(uint16_t bg);
+ui_widget_t *ui_root(void);
+
+// Constructors return NULL once the pool is empty. A label's x, y is the text
+// origin, on the baseline as for gfx_draw_text. Arcs run clockwise from start
+// degrees (3 o'clock is 0) over sweep, clamped to 0..360, the first
+// value / max of it in color and the rest in track.
+ui_widget_t *ui_container(ui_widget_t *parent, int16_t x, int16_t y, int16_t w, int16_t h);
+ui_widget_t *ui_label(ui_widget_t *parent, int16_t x, int16_t y, const GFXfont *font, uint16_t color);
+ui_widget_t *ui_image(ui_widget_t *parent, int16_t x, int16_t y, const gfx_image_t *img);
+ui_widget_t *ui_arc(ui_widget_t *parent, int16_t cx, int16_t cy, int16_t r, uint8_t thickness,
+                    int16_t start, int16_t sweep, uint16_t max, uint16_t color, uint16_t track);
+ui_widget_t *ui_progress(ui_widget_t *parent, int16_t x, int16_t y, int16_t w, int16_t h,
+                         uint16_t max, uint16_t color, uint16_t track);
+ui_widget_t *ui_canvas(ui_widget_t *parent, int16_t x, int16_t y, int16_t w, int16_t h, ui_draw_t draw, void *arg);
+
+// Frees the widget and everything under it
+void ui_delete(ui_widget_t *w);
+
+// Setters damage only what changes
+void ui_set_text(ui_widget_t *w, const char *text);
+void ui_set_value(ui_widget_t *w, uint16_t value);
+void ui_set_color(ui_widget_t *w, uint16_t color);
+void ui_set_bg(ui_widget_t *w, uint16_t bg);    // Makes containers and labels opaque
+void ui_set_visible(ui_widget_t *w, bool visible);
+void ui_set_z(ui_widget_t *w, int8_t z);
+void ui_move(ui_widget_t *w, int16_t x, int16_t y);
+
+// Damage the widget, or a screen area, to have it drawn again
+void ui_invalidate(ui_widget_t *w);
+void ui_invalidate_rect(int16_t x, int16_t y, int16_t w, int16_t h);
+
+// Repaint the damaged regions
+void ui_render(void);
+
+#endif // UI_H
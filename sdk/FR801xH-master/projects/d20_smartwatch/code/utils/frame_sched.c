@@ -0,0 +1,104 @@
+#include "utils/frame_sched.h"
+#include "utils/utils.h"
+#include "ll.h"
+#include "os_task.h"
+#include "os_timer.h"
+#include "driver_system.h"
+#include <stddef.h>
+
+#define FRAME_EVT_TICK      1
+
+static os_timer_t _timer;
+static uint16_t _task_id = TASK_ID_NONE;
+static frame_sched_func_t _func;
+static uint32_t _period_ms;
+static uint32_t _last_ms;
+static volatile bool _pending;
+static frame_sched_stats_t _stats;
+
+// One event in the queue at most, ticks that find one there are dropped
+static void _post(void) {
+    GLOBAL_INT_DISABLE();
+    bool post = !_pending;
+    _pending = true;
+    GLOBAL_INT_RESTORE();
+
+    if (post) {
+        os_event_t evt = {
+            .event_id = FRAME_EVT_TICK,
+            .src_task_id = _task_id,
+        };
+        os_msg_post(_task_id, &evt);
+    }
+}
+
+static void _tick(void *arg) {
+    (void)arg;
+    _post();
+}
+
+static int _task(os_event_t *evt) {
+    if (evt->event_id != FRAME_EVT_TICK) return EVT_CONSUMED;
+
+    _pending = false;
+    if (!_func) return EVT_CONSUMED;
+
+    uint32_t start = system_get_curr_time();
+    uint32_t elapsed = time_since_ms(start, _last_ms);
+    _last_ms = start;
+
+    // Whole periods gone by, one of them is this frame
+    uint32_t ticks = (elapsed + _period_ms / 2) / _period_ms;
+    if (ticks > 1) _stats.missed += ticks - 1;
+
+    _func(elapsed);
+
+    uint32_t render = time_since_ms(system_get_curr_time(), start);
+    _stats.frames++;
+    _stats.render_ms = render;
+    _stats.render_total_ms += render;
+    if (render > _stats.render_max_ms) _stats.render_max_ms = render;
+
+    return EVT_CONSUMED;
+}
+
+void frame_sched_start(uint32_t period_ms, frame_sched_func_t func) {
+    if (_task_id == TASK_ID_NONE) {
+        _task_id = os_task_create(_task);
+        os_timer_init(&_timer, _tick, NULL);
+    }
+
+    _func = func;
+    _period_ms = period_ms ? period_ms : 1;
+    _last_ms = system_get_curr_time();
+    os_timer_start(&_timer, _period_ms, true);
+}
+
+void frame_sched_stop(void) {
+    os_timer_stop(&_timer);
+    _func = NULL;
+}
+
+void frame_sched_set_period(uint32_t period_ms) {
+    if (!period_ms) period_ms = 1;
+    if (period_ms == _period_ms) return;
+
+    _period_ms = period_ms;
+    if (_func) os_timer_start(&_timer, _period_ms, true);
+}
+
+uint32_t frame_sched_get_period(void) {
+    return _period_ms;
+}
+
+void frame_sched_trigger(void) {
+    if (_func) _post();
+}
+
+void frame_sched_get_stats(frame_sched_stats_t *stats) {
+    *stats = _stats;
+}
+
+void frame_sched_reset_stats(void) {
+    _stats = (frame_sched_stats_t){0};
+}
@@ -0,0 +1,36 @@
+#ifndef FRAME_SCHED_H
+#define FRAME_SCHED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Fixed rate frame ticks. An os_timer ticks every period and posts an event
+// to a task that calls the frame function, so the CPU is free between frames
+// instead of spinning in a delay, and render time doesn't stretch the frame
+// rate. Ticks that pass while a frame is still being drawn are dropped and
+// counted as missed, the frame function is told the time since the last one.
+typedef void (*frame_sched_func_t)(uint32_t elapsed_ms);
+
+// Times are in ms, as precise as system_get_curr_time
+typedef struct {
+    uint32_t frames;
+    uint32_t missed;        // Ticks dropped because a frame overran
+    uint32_t render_ms;     // Last frame
+    uint32_t render_max_ms;
+    uint32_t render_total_ms;
+} frame_sched_stats_t;
+
+void frame_sched_start(uint32_t period_ms, frame_sched_func_t func);
+void frame_sched_stop(void);
+
+// Takes effect from the next tick
+void frame_sched_set_period(uint32_t period_ms);
+uint32_t frame_sched_get_period(void);
+
+// Run a frame now, safe to call from interrupts
+void frame_sched_trigger(void);
+
+void frame_sched_get_stats(frame_sched_stats_t *stats);
+void frame_sched_reset_stats(void);
+
+#endif // FRAME_SCHED_H
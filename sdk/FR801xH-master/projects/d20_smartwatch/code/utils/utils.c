@@ -44,4 +44,12 @@ bool read_button_state() {
 void delay_ms(uint32_t ms)
 {
     co_delay_100us(ms * 10);
+}
+
+// system_get_curr_time wraps after 0x4FFFFFF
+#define CURR_TIME_WRAP 0x5000000
+
+uint32_t time_since_ms(uint32_t now, uint32_t then)
+{
+    return (now >= then) ? now - then : now + CURR_TIME_WRAP - then;
 }
\ No newline at end of file
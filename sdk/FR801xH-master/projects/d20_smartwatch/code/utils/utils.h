@@ -12,5 +12,6 @@ void device_vibrate(int count);
 void device_led_blank(int count);
 bool read_button_state();
 void delay_ms(uint32_t ms);
+uint32_t time_since_ms(uint32_t now, uint32_t then);    // system_get_curr_time stamps
 
 #endif // UTILS_H
\ No newline at end of file
@@ -0,0 +1,493 @@
+// Host checks for the ANCS client: the notification store and the Data
+// Source parser, fed responses split across notifications the way iOS
+// sends them. The GATT client and the timer are stubs, messages go to the
+// handler the client registers and the batch window and timeouts only run
+// out when a test fires the timer.
+//
+//   ancs_test       prints each failed check, exits non-zero on any
+
+#include "ANCS_client.h"
+#include "ANCS_ntf_store.h"
+#include "os_timer.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(cond) _check((cond), #cond, __LINE__)
+
+static unsigned _checks;
+static unsigned _failed;
+
+static gatt_msg_handler_t _gatt_handler;
+
+static os_timer_func_t _timer_func;
+static void *_timer_arg;
+static bool _timer_armed;
+
+static uint8_t _req[64];
+static uint16_t _req_len;
+static unsigned _req_count;
+
+static uint8_t _evt[16];
+static uint32_t _evt_uid[16];
+static uint8_t _evt_count[16];
+static unsigned _evt_num;
+
+static void _check(bool ok, const char *what, int line) {
+    _checks++;
+    if (!ok) {
+        _failed++;
+        printf("ancs_test.c:%d: %s\n", line, what);
+    }
+}
+
+// Stubs for the SDK
+
+int co_printf(const char *format, ...) {
+    return 0;
+}
+
+void os_timer_init(os_timer_t *ptimer, os_timer_func_t pfunction, void *parg) {
+    _timer_func = pfunction;
+    _timer_arg = parg;
+}
+
+void os_timer_start(os_timer_t *ptimer, uint32_t ms, bool repeat_flag) {
+    _timer_armed = true;
+}
+
+void os_timer_stop(os_timer_t *ptimer) {
+    _timer_armed = false;
+}
+
+uint8_t gatt_add_client(gatt_client_t *p_client) {
+    _gatt_handler = p_client->gatt_msg_handler;
+    return 0;
+}
+
+void gatt_client_enable_ntf(gatt_client_enable_ntf_t ntf_enable_att) {
+}
+
+void gatt_client_write_req(gatt_client_write_t write_att) {
+    _req_len = write_att.data_len < sizeof(_req) ? write_att.data_len : sizeof(_req);
+    memcpy(_req, write_att.p_data, _req_len);
+    _req_count++;
+}
+
+void gatt_client_write_cmd(gatt_client_write_t write_att) {
+}
+
+void gatt_client_read(gatt_client_read_t read_att) {
+}
+
+// Helpers
+
+static void _ntf_cb(uint8_t conidx, uint8_t evt, uint32_t uid, uint8_t count) {
+    if (_evt_num < sizeof(_evt)) {
+        _evt[_evt_num] = evt;
+        _evt_uid[_evt_num] = uid;
+        _evt_count[_evt_num] = count;
+        _evt_num++;
+    }
+}
+
+static void _fire_timer(void) {
+    if (_timer_armed) {
+        _timer_armed = false;
+        _timer_func(_timer_arg);
+    }
+}
+
+static void _gatt_ntf(uint16_t att_idx, uint8_t *data, uint16_t len) {
+    gatt_msg_t msg = { .msg_evt = GATTC_MSG_NTF_REQ, .conn_idx = 0, .att_idx = att_idx };
+
+    msg.param.msg.p_msg_data = data;
+    msg.param.msg.msg_len = len;
+    _gatt_handler(&msg);
+}
+
+static void _announce(uint8_t event_id, uint8_t category, uint32_t uid) {
+    uint8_t src[8] = { event_id, 0, category, 1, uid, uid >> 8, uid >> 16, uid >> 24 };
+    _gatt_ntf(ANCS_ATT_IDX_NTF_SRC, src, sizeof(src));
+}
+
+// UID the request in flight asks for
+static uint32_t _req_uid(void) {
+    return _req[1] | _req[2] << 8 | (uint32_t)_req[3] << 16 | (uint32_t)_req[4] << 24;
+}
+
+static uint16_t _rsp_start(uint8_t *rsp, uint32_t uid) {
+    rsp[0] = ANCS_CMD_ID_GET_NOTIFICATION_ATTR;
+    rsp[1] = uid;
+    rsp[2] = uid >> 8;
+    rsp[3] = uid >> 16;
+    rsp[4] = uid >> 24;
+    return 5;
+}
+
+static uint16_t _rsp_att(uint8_t *rsp, uint16_t len, uint8_t att_id, const char *value) {
+    uint16_t n = strlen(value);
+    rsp[len++] = att_id;
+    rsp[len++] = n;
+    rsp[len++] = n >> 8;
+    memcpy(rsp + len, value, n);
+    return len + n;
+}
+
+// Hand a response to the parser chunk bytes at a time
+static void _feed(const uint8_t *rsp, uint16_t len, uint16_t chunk) {
+    for (uint16_t i = 0; i < len; i += chunk) {
+        uint16_t n = (len - i < chunk) ? len - i : chunk;
+        _gatt_ntf(ANCS_ATT_IDX_DATA_SRC, (uint8_t *)rsp + i, n);
+    }
+}
+
+static uint16_t _header_rsp(uint8_t *rsp, uint32_t uid, const char *app, const char *title) {
+    uint16_t len = _rsp_start(rsp, uid);
+    len = _rsp_att(rsp, len, 0, app);
+    return _rsp_att(rsp, len, 1, title);
+}
+
+static void _gatt_evt(gatt_msg_evt_t evt, uint8_t operation, void *arg) {
+    gatt_msg_t msg = { .msg_evt = evt, .conn_idx = 0 };
+
+    msg.param.op.operation = operation;
+    msg.param.op.arg = arg;
+    _gatt_handler(&msg);
+}
+
+// Answer to the oldest Control Point write still open
+static void _write_done(uint8_t status) {
+    gatt_msg_t msg = { .msg_evt = GATTC_MSG_CMP_EVT, .conn_idx = 0, .att_idx = ANCS_ATT_IDX_CTL_POINT };
+
+    msg.param.op.operation = GATT_OP_WRITE_REQ;
+    msg.param.op.status = status;
+    _gatt_handler(&msg);
+}
+
+// Answer header requests until the queue runs dry, apps[uid % num] posted each
+static unsigned _answer_headers(const char *const *apps, uint8_t num) {
+    uint8_t rsp[128];
+    unsigned answered = 0;
+
+    while (_timer_armed && _req_count > answered) {
+        uint32_t uid = _req_uid();
+        uint16_t len = _header_rsp(rsp, uid, apps[uid % num], "Hi");
+        answered++;
+        _feed(rsp, len, 20);
+    }
+    return answered;
+}
+
+static void _reset(void) {
+    ANCS_disconnected();
+    ANCS_ntf_store_clear();
+    ANCS_ntf_cb_register(_ntf_cb);
+    _evt_num = 0;
+    _req_count = 0;
+}
+
+// Tests
+
+static void _test_store_eviction(void) {
+    ANCS_ntf_store_clear();
+    for (uint32_t uid = 1; uid <= ANCS_NTF_STORE_NUM; uid++) {
+        ANCS_ntf_store_add(uid);
+    }
+    CHECK(ANCS_ntf_store_count() == ANCS_NTF_STORE_NUM);
+    CHECK(ANCS_ntf_store_get(0)->uid == ANCS_NTF_STORE_NUM);
+    CHECK(ANCS_ntf_store_get(ANCS_NTF_STORE_NUM - 1)->uid == 1);
+    CHECK(ANCS_ntf_store_get(ANCS_NTF_STORE_NUM) == NULL);
+
+    // Full, the oldest goes
+    ANCS_ntf_store_add(100);
+    CHECK(ANCS_ntf_store_find(1) == NULL);
+    CHECK(ANCS_ntf_store_find(2) != NULL);
+    CHECK(ANCS_ntf_store_get(0)->uid == 100);
+
+    // A removal leaves room, nothing live is pushed out
+    ANCS_ntf_store_remove(5);
+    CHECK(ANCS_ntf_store_count() == ANCS_NTF_STORE_NUM - 1);
+    ANCS_ntf_store_add(101);
+    CHECK(ANCS_ntf_store_find(2) != NULL);
+    CHECK(ANCS_ntf_store_count() == ANCS_NTF_STORE_NUM);
+
+    // Adding a stored UID again makes it the newest, the oldest is 3 now
+    ANCS_ntf_store_add(2);
+    CHECK(ANCS_ntf_store_get(0)->uid == 2);
+    ANCS_ntf_store_add(102);
+    CHECK(ANCS_ntf_store_find(3) == NULL);
+    CHECK(ANCS_ntf_store_find(2) != NULL);
+    CHECK(ANCS_ntf_store_count() == ANCS_NTF_STORE_NUM);
+
+    ANCS_ntf_store_clear();
+    CHECK(ANCS_ntf_store_count() == 0);
+    CHECK(ANCS_ntf_store_find(2) == NULL);
+    CHECK(ANCS_ntf_store_get(0) == NULL);
+}
+
+// The project's ancs_app_config.h list is the one in use
+static void _test_app_list(void) {
+    CHECK(ANCS_app_lookup("com.apple.reminders")->category == ANCS_APP_CAT_SCHEDULE);
+    CHECK(ANCS_app_lookup("com.tencent.xin")->icon == ANCS_APP_ICON_WEIXIN);
+    CHECK(ANCS_app_lookup("com.example.none")->bundle_id == NULL);
+}
+
+static void _test_split_response(void) {
+    static const uint16_t chunks[] = { 1, 2, 3, 7, 20 };
+
+    for (uint8_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+        uint8_t rsp[128];
+        uint32_t uid = 0x1000 + c;
+
+        _reset();
+        _announce(EVENT_ID_NOTIFICATION_ADD, 4, uid);
+        CHECK(_req_count == 0);
+        _fire_timer();
+        CHECK(_req_count == 1);
+        CHECK(_req_uid() == uid);
+
+        // Attribute IDs and lengths land on chunk boundaries too
+        uint16_t len = _header_rsp(rsp, uid, "com.apple.MobileSMS", "Alice");
+        _feed(rsp, len, chunks[c]);
+
+        struct ancs_ntf *ntf = ANCS_ntf_store_find(uid);
+        CHECK(ntf != NULL);
+        CHECK(ntf->fetched == ANCS_NTF_HEADER);
+        CHECK(strcmp(ntf->app_id, "com.apple.MobileSMS") == 0);
+        CHECK(strcmp(ntf->title, "Alice") == 0);
+        CHECK(ntf->app && ntf->app->icon == ANCS_APP_ICON_SMS);
+        CHECK(_evt_num == 1 && _evt[0] == ANCS_NTF_EVT_SUMMARY && _evt_uid[0] == uid);
+    }
+}
+
+static void _test_open(void) {
+    uint8_t rsp[256];
+    uint32_t uid = 0x2000;
+    char msg[ANCS_NTF_MSG_LEN];
+
+    _reset();
+    _announce(EVENT_ID_NOTIFICATION_ADD, 4, uid);
+    _fire_timer();
+    uint16_t len = _header_rsp(rsp, uid, "com.tencent.xin", "Bob");
+    _feed(rsp, len, 5);
+
+    // The rest comes in once opened, from the subtitle on
+    ANCS_ntf_open(0, uid);
+    CHECK(_req_count == 2);
+    CHECK(_req[5] == 2);
+
+    memset(msg, 'm', sizeof(msg) - 1);
+    msg[sizeof(msg) - 1] = 0;
+    len = _rsp_start(rsp, uid);
+    len = _rsp_att(rsp, len, 2, "");
+    len = _rsp_att(rsp, len, 3, msg);
+    len = _rsp_att(rsp, len, 4, "300");
+    len = _rsp_att(rsp, len, 5, "20261017T101500");
+    len = _rsp_att(rsp, len, 6, "Reply");
+    len = _rsp_att(rsp, len, 7, "Clear");
+    _feed(rsp, len, 20);
+
+    struct ancs_ntf *ntf = ANCS_ntf_store_find(uid);
+    CHECK(ntf->fetched == ANCS_NTF_FULL);
+    CHECK(strcmp(ntf->title, "Bob") == 0);
+    CHECK(strcmp(ntf->msg, msg) == 0);
+    CHECK(ntf->msg_size == 300);
+    CHECK(strcmp(ntf->date, "20261017T101500") == 0);
+    CHECK(_evt_num == 2 && _evt[1] == ANCS_NTF_EVT_OPENED && _evt_uid[1] == uid);
+}
+
+static void _test_partial_response(void) {
+    uint8_t rsp[128];
+
+    _reset();
+    _announce(EVENT_ID_NOTIFICATION_ADD, 4, 0x3000);
+    _announce(EVENT_ID_NOTIFICATION_ADD, 4, 0x3001);
+    _fire_timer();
+    CHECK(_req_uid() == 0x3000);
+
+    // Removed while its response is half in, the rest is dropped and the
+    // next fetch goes out straight away
+    uint16_t len = _header_rsp(rsp, 0x3000, "com.apple.MobileSMS", "Carol");
+    _feed(rsp, 10, 10);
+    _announce(EVENT_ID_NOTIFICATION_REMOVED, 4, 0x3000);
+    _feed(rsp + 10, len - 10, len - 10);
+    CHECK(ANCS_ntf_store_find(0x3000) == NULL);
+    CHECK(_req_count == 2);
+    CHECK(_req_uid() == 0x3001);
+
+    // A response that stops short is given up on at the timeout
+    len = _header_rsp(rsp, 0x3001, "com.apple.MobileSMS", "Dave");
+    _feed(rsp, len - 2, 4);
+    CHECK(ANCS_ntf_store_find(0x3001)->fetched == ANCS_NTF_NONE);
+    _fire_timer();
+
+    // and the parser takes the next response from its start
+    _announce(EVENT_ID_NOTIFICATION_ADD, 4, 0x3002);
+    _fire_timer();
+    CHECK(_req_uid() == 0x3002);
+    len = _header_rsp(rsp, 0x3002, "com.apple.MobileSMS", "Erin");
+    _feed(rsp, len, 3);
+    CHECK(ANCS_ntf_store_find(0x3002)->fetched == ANCS_NTF_HEADER);
+    CHECK(strcmp(ANCS_ntf_store_find(0x3002)->title, "Erin") == 0);
+}
+
+static void _test_burst(void) {
+    static const char *const sms[] = { "com.apple.MobileSMS" };
+
+    // Far more than the store holds: the newest ones are fetched
+    _reset();
+    for (uint32_t uid = 0x4000; uid < 0x4000 + 30; uid++) {
+        _announce(EVENT_ID_NOTIFICATION_ADD, 4, uid);
+    }
+    _fire_timer();
+    CHECK(_req_uid() == 0x4000 + 30 - ANCS_NTF_STORE_NUM);
+    CHECK(_answer_headers(sms, 1) == ANCS_NTF_STORE_NUM);
+    CHECK(_evt_num == 1 && _evt[0] == ANCS_NTF_EVT_SUMMARY);
+    CHECK(_evt_uid[0] == 0x4000 + 29 && _evt_count[0] == ANCS_NTF_STORE_NUM);
+}
+
+static void _test_summary_other(void) {
+    static const char *const apps[] = { "a.one", "a.two", "a.three", "a.four", "a.five", "a.six" };
+
+    // One each from six apps, the last summary counts those past the first
+    _reset();
+    for (uint32_t uid = 0x5000; uid < 0x5000 + 6; uid++) {
+        _announce(EVENT_ID_NOTIFICATION_ADD, 4, uid);
+    }
+    _fire_timer();
+    _answer_headers(apps, 6);
+    CHECK(_evt_num == ANCS_SUMMARY_NUM);
+    CHECK(_evt_count[0] == 1 && _evt_uid[0] == 0x5000);
+    CHECK(_evt_count[ANCS_SUMMARY_NUM - 1] == 6 - (ANCS_SUMMARY_NUM - 1));
+    CHECK(_evt_uid[ANCS_SUMMARY_NUM - 1] == 0x5005);
+}
+
+static void _test_open_full_queue(void) {
+    // With every stored notification waiting, an opened one still goes first
+    _reset();
+    for (uint32_t uid = 0x6000; uid < 0x6000 + ANCS_NTF_STORE_NUM; uid++) {
+        _announce(EVENT_ID_NOTIFICATION_ADD, 4, uid);
+    }
+    ANCS_ntf_open(0, 0x6003);
+    CHECK(_req_count == 1);
+    CHECK(_req_uid() == 0x6003);
+    CHECK(_req[5] == 0);
+}
+
+static void _test_removed_in_flight(void) {
+    uint8_t rsp[128];
+
+    // Removed before any of its reply came, the reply moves the queue on
+    _reset();
+    _announce(EVENT_ID_NOTIFICATION_ADD, 4, 0x7000);
+    _announce(EVENT_ID_NOTIFICATION_ADD, 4, 0x7001);
+    _fire_timer();
+    _announce(EVENT_ID_NOTIFICATION_REMOVED, 4, 0x7000);
+    uint16_t len = _header_rsp(rsp, 0x7000, "com.apple.MobileSMS", "Gone");
+    _feed(rsp, len, len);
+    CHECK(_req_count == 2);
+    CHECK(_req_uid() == 0x7001);
+}
+
+static void _test_modified_in_flight(void) {
+    uint8_t rsp[128];
+
+    // Modified while its header is half in, the old reply is dropped and
+    // the new content fetched
+    _reset();
+    _announce(EVENT_ID_NOTIFICATION_ADD, 4, 0xa000);
+    _fire_timer();
+    uint16_t len = _header_rsp(rsp, 0xa000, "com.apple.MobileSMS", "Old title");
+    _feed(rsp, 20, 20);
+    _announce(EVENT_ID_NOTIFICATION_MODIFIED, 4, 0xa000);
+    _feed(rsp + 20, len - 20, len - 20);
+    CHECK(ANCS_ntf_store_find(0xa000)->fetched == ANCS_NTF_NONE);
+    CHECK(_req_count == 1);
+
+    _fire_timer();
+    CHECK(_req_count == 2);
+    CHECK(_req_uid() == 0xa000);
+    len = _header_rsp(rsp, 0xa000, "com.apple.MobileSMS", "New title");
+    _feed(rsp, len, 20);
+
+    struct ancs_ntf *ntf = ANCS_ntf_store_find(0xa000);
+    CHECK(ntf->fetched == ANCS_NTF_HEADER);
+    CHECK(strcmp(ntf->app_id, "com.apple.MobileSMS") == 0);
+    CHECK(strcmp(ntf->title, "New title") == 0);
+    CHECK(ntf->app && ntf->app->icon == ANCS_APP_ICON_SMS);
+}
+
+static void _test_other_writes(void) {
+    uint16_t handles[3] = { 1, 2, 3 };
+    uint8_t rsp[128];
+
+    _reset();
+    _gatt_evt(GATTC_MSG_CMP_EVT, GATT_OP_PEER_SVC_REGISTERED, handles);
+    _announce(EVENT_ID_NOTIFICATION_ADD, 4, 0x9000);
+    _announce(EVENT_ID_NOTIFICATION_ADD, 4, 0x9001);
+    _announce(EVENT_ID_NOTIFICATION_ADD, 4, 0x9002);
+
+    // A refused Perform Action ahead of the fetch leaves the fetch alone
+    ANCS_perform_ntf_act(0, 0x9000, ANCS_ACT_ID_NEGATIVE);
+    _fire_timer();
+    CHECK(_req_count == 2);
+    CHECK(_req_uid() == 0x9000);
+    _write_done(0x0a);
+    CHECK(_req_count == 2);
+    CHECK(_timer_armed);
+
+    // An accepted one doesn't stand in for the fetch's answer, the fetch's
+    // own refusals still move the queue on
+    ANCS_perform_ntf_act(0, 0x9001, ANCS_ACT_ID_POSITIVE);
+    _write_done(0x0a);
+    CHECK(_req_count == 4);
+    CHECK(_req_uid() == 0x9001);
+    _write_done(0);
+    _write_done(0x0a);
+    CHECK(_req_count == 5);
+    CHECK(_req_uid() == 0x9002);
+
+    _write_done(0);
+    uint16_t len = _header_rsp(rsp, 0x9002, "com.apple.MobileSMS", "Hank");
+    _feed(rsp, len, 20);
+    CHECK(ANCS_ntf_store_find(0x9002)->fetched == ANCS_NTF_HEADER);
+}
+
+static void _test_link_lost(void) {
+    uint16_t handles[3] = { 1, 2, 3 };
+
+    _reset();
+    _gatt_evt(GATTC_MSG_CMP_EVT, GATT_OP_PEER_SVC_REGISTERED, handles);
+    _announce(EVENT_ID_NOTIFICATION_ADD, 4, 0x8000);
+    _announce(EVENT_ID_NOTIFICATION_ADD, 4, 0x8001);
+    _fire_timer();
+    _gatt_evt(GATTC_MSG_LINK_LOST, 0, NULL);
+    CHECK(!_timer_armed);
+    CHECK(ANCS_ntf_store_count() == 0);
+
+    // Reconnected, the same UIDs are fetched again
+    _gatt_evt(GATTC_MSG_CMP_EVT, GATT_OP_PEER_SVC_REGISTERED, handles);
+    _announce(EVENT_ID_NOTIFICATION_ADD, 4, 0x8001);
+    _fire_timer();
+    CHECK(_req_count == 2);
+    CHECK(_req_uid() == 0x8001);
+}
+
+int main(void) {
+    ANCS_gatt_add_client();
+    _test_store_eviction();
+    _test_app_list();
+    _test_split_response();
+    _test_open();
+    _test_partial_response();
+    _test_burst();
+    _test_summary_other();
+    _test_open_full_queue();
+    _test_removed_in_flight();
+    _test_modified_in_flight();
+    _test_other_writes();
+    _test_link_lost();
+
+    printf("ancs_test: %u checks, %u failed\n", _checks, _failed);
+    return _failed ? 1 : 0;
+}
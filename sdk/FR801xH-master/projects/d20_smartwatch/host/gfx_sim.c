@@ -0,0 +1,95 @@
+// Runs the watch app on the host against the ST7789 model. Each app_update
+// is one frame, its bus cost is printed and the panel can be dumped to a
+// directory as PNG (or PPM with -p) for comparing against known good frames.
+//
+//   gfx_sim [-p] [-n frames] [-o outdir] [-s spanlog]
+//   gfx_sim -b      run the rendering benchmark instead, as on the watch
+//
+// -s also counts the runs and points gfx.c produces each frame and writes
+// every one of them to spanlog ("-" for no log).
+
+#include "app/app.h"
+#include "bench/gfx_bench.h"
+#include "sdk_host.h"
+#include "span_rec.h"
+#include "ssp_host.h"
+#include "st7789_sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SPI_HZ          24000000
+#define PRESS_EVERY     8           // Frames between simulated button presses
+
+static const char *_outdir;
+static bool _ppm;
+static bool _spans;
+static FILE *_span_log;
+
+static void _end_frame(const char *name) {
+    st7789_sim_stats_t s;
+    char path[512];
+
+    st7789_sim_stats(&s);
+    printf("%-10s %8u bytes %6u cmds %5u windows %6u cs %7u pixels %7.2f ms\n", name, s.bytes, s.commands,
+           s.windows, s.cs_cycles, s.pixels, s.bytes * 8 * 1000.0 / SPI_HZ);
+    if (_spans) {
+        span_rec_stats_t r;
+        span_rec_stats(&r);
+        printf("%-10s %8u fills %6u px %5u batches %6u points\n", "", r.fills, r.fill_pixels, r.batches, r.points);
+        if (_span_log) fprintf(_span_log, "# %s\n", name);
+        span_rec_reset_stats();
+    }
+
+    if (_outdir) {
+        snprintf(path, sizeof(path), "%s/%s.%s", _outdir, name, _ppm ? "ppm" : "png");
+        int err = _ppm ? st7789_sim_write_ppm(path, DISPLAY_WIDTH, DISPLAY_HEIGHT)
+                       : st7789_sim_write_png(path, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+        if (err) fprintf(stderr, "can't write %s\n", path);
+    }
+    st7789_sim_reset_stats();
+}
+
+int main(int argc, char **argv) {
+    int frames = 32;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "bpn:o:s:")) != -1) {
+        switch (opt) {
+        case 'b':
+            st7789_sim_init();
+            gfx_bench_run();
+            return 0;
+        case 'p': _ppm = true; break;
+        case 'n': frames = atoi(optarg); break;
+        case 'o': _outdir = optarg; break;
+        case 's':
+            _spans = true;
+            if (strcmp(optarg, "-") && !(_span_log = fopen(optarg, "w"))) {
+                perror(optarg);
+                return 1;
+            }
+            break;
+        default:
+            fprintf(stderr, "usage: gfx_sim [-b] [-p] [-n frames] [-o outdir] [-s spanlog]\n");
+            return 1;
+        }
+    }
+
+    st7789_sim_init();
+    if (_spans) span_rec_start(_span_log);
+    app_init();
+    _end_frame("init");
+
+    for (int i = 0; i < frames; i++) {
+        char name[16];
+        sdk_host_set_button(i % PRESS_EVERY == PRESS_EVERY - 1);
+        app_update(APP_FRAME_MS);
+        ssp_host_run();
+        snprintf(name, sizeof(name), "frame%03d", i);
+        _end_frame(name);
+    }
+    if (_span_log) fclose(_span_log);
+    return 0;
+}
@@ -0,0 +1,231 @@
+// Converts a binary PPM (P6) picture into a run length coded gfx_image_t.
+//
+//   gcc -O2 -o img2gfx img2gfx.c
+//   convert background.png background.ppm
+//   ./img2gfx background.ppm background ../code/images
+//
+// writes images/background.c and images/background.h. Pictures with up to 256
+// colors are stored as palette indexes when that comes out smaller, -r keeps
+// RGB565 pixels. See gfx_image_t in display/gfx.h for the packet layout.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_PACKET 128
+
+typedef struct {
+    uint8_t *buf;
+    size_t len, cap;
+} out_t;
+
+static void _put(out_t *o, uint8_t b) {
+    if (o->len == o->cap) {
+        o->cap = o->cap ? o->cap * 2 : 4096;
+        o->buf = realloc(o->buf, o->cap);
+        if (!o->buf) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    o->buf[o->len++] = b;
+}
+
+static void _put_pixel(out_t *o, uint16_t v, int indexed) {
+    if (indexed) {
+        _put(o, (uint8_t)v);
+    } else {
+        _put(o, v >> 8);
+        _put(o, v & 0xFF);
+    }
+}
+
+// Skip whitespace and comments in a PPM header
+static int _ppm_int(FILE *f) {
+    int c, v = 0;
+
+    do {
+        c = fgetc(f);
+        if (c == '#') {
+            while (c != '\n' && c != EOF) c = fgetc(f);
+        }
+    } while (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+
+    if (c < '0' || c > '9') return -1;
+    while (c >= '0' && c <= '9') {
+        v = v * 10 + (c - '0');
+        c = fgetc(f);
+    }
+    return v;
+}
+
+static uint16_t *_load_ppm(const char *path, int *w, int *h) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return NULL;
+    }
+
+    int max;
+    if (fgetc(f) != 'P' || fgetc(f) != '6' || (*w = _ppm_int(f)) <= 0 || (*h = _ppm_int(f)) <= 0 ||
+        (max = _ppm_int(f)) != 255) {
+        fprintf(stderr, "%s: only 8 bit binary PPM (P6) is supported\n", path);
+        fclose(f);
+        return NULL;
+    }
+
+    uint16_t *pix = malloc((size_t)*w * *h * sizeof(uint16_t));
+    for (int i = 0; i < *w * *h; i++) {
+        int r = fgetc(f), g = fgetc(f), b = fgetc(f);
+        if (b == EOF) {
+            fprintf(stderr, "%s: truncated\n", path);
+            free(pix);
+            fclose(f);
+            return NULL;
+        }
+        pix[i] = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+    }
+    fclose(f);
+    return pix;
+}
+
+// Pack one row, runs pay off from 2 pixels for RGB565 and 3 for indexes
+static void _encode_row(out_t *o, const uint16_t *row, int w, int indexed) {
+    int min_run = indexed ? 3 : 2;
+    int x = 0;
+
+    while (x < w) {
+        int run = 1;
+        while (x + run < w && run < MAX_PACKET && row[x + run] == row[x]) run++;
+
+        if (run >= min_run) {
+            _put(o, 0x80 | (run - 1));
+            _put_pixel(o, row[x], indexed);
+            x += run;
+            continue;
+        }
+
+        // Literal up to the next run worth taking
+        int len = 0;
+        while (x + len < w && len < MAX_PACKET) {
+            int r = 1;
+            while (x + len + r < w && r < min_run && row[x + len + r] == row[x + len]) r++;
+            if (r >= min_run) break;
+            len++;
+        }
+        _put(o, len - 1);
+        for (int i = 0; i < len; i++) _put_pixel(o, row[x + i], indexed);
+        x += len;
+    }
+}
+
+static void _encode(out_t *o, const uint16_t *pix, int w, int h, int indexed) {
+    for (int y = 0; y < h; y++) _encode_row(o, &pix[y * w], w, indexed);
+}
+
+static int _write_files(const char *name, const char *dir, const out_t *o, int w, int h,
+                        const uint16_t *palette, int colors) {
+    char path[1024];
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s/%s.h", dir, name);
+    if (!(f = fopen(path, "w"))) {
+        perror(path);
+        return -1;
+    }
+    fprintf(f, "#ifndef IMAGE_%s_H\n#define IMAGE_%s_H\n\n", name, name);
+    fprintf(f, "#include \"display/gfx.h\"\n\n");
+    fprintf(f, "extern const gfx_image_t %s;\n\n", name);
+    fprintf(f, "#endif // IMAGE_%s_H\n", name);
+    fclose(f);
+
+    snprintf(path, sizeof(path), "%s/%s.c", dir, name);
+    if (!(f = fopen(path, "w"))) {
+        perror(path);
+        return -1;
+    }
+    fprintf(f, "#include \"%s.h\"\n\n", name);
+    fprintf(f, "// %dx%d, %zu bytes packed from %d\n", w, h, o->len, w * h * 2);
+    fprintf(f, "static const uint8_t %sData[] = {", name);
+    for (size_t i = 0; i < o->len; i++) {
+        fprintf(f, "%s0x%02X,", (i % 12) ? " " : "\n    ", o->buf[i]);
+    }
+    fprintf(f, "\n};\n\n");
+
+    if (palette) {
+        fprintf(f, "static const uint16_t %sPalette[] = {", name);
+        for (int i = 0; i < colors; i++) {
+            fprintf(f, "%s0x%04X,", (i % 8) ? " " : "\n    ", palette[i]);
+        }
+        fprintf(f, "\n};\n\n");
+    }
+
+    fprintf(f, "const gfx_image_t %s = {\n", name);
+    fprintf(f, "    %sData,\n", name);
+    if (palette) {
+        fprintf(f, "    %sPalette,\n", name);
+    } else {
+        fprintf(f, "    NULL,\n");
+    }
+    fprintf(f, "    %d, %d, %s\n};\n", w, h, palette ? "GFX_IMAGE_RLE_INDEXED" : "GFX_IMAGE_RLE565");
+    fclose(f);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int force_rgb = 0;
+
+    if (argc > 1 && !strcmp(argv[1], "-r")) {
+        force_rgb = 1;
+        argc--;
+        argv++;
+    }
+    if (argc != 4) {
+        fprintf(stderr, "usage: img2gfx [-r] input.ppm name outdir\n");
+        return 1;
+    }
+
+    int w, h;
+    uint16_t *pix = _load_ppm(argv[1], &w, &h);
+    if (!pix) return 1;
+    if (w > 0xFFFF || h > 0xFFFF) {
+        fprintf(stderr, "%s: too large\n", argv[1]);
+        return 1;
+    }
+
+    out_t rgb = { 0 };
+    _encode(&rgb, pix, w, h, 0);
+
+    // Try a palette when the picture has few enough colors
+    static uint16_t palette[256];
+    static int16_t lookup[65536];
+    int colors = 0;
+    memset(lookup, -1, sizeof(lookup));
+    for (int i = 0; i < w * h && colors <= 256; i++) {
+        if (lookup[pix[i]] < 0) {
+            if (colors < 256) palette[colors] = pix[i];
+            lookup[pix[i]] = colors++;
+        }
+    }
+
+    out_t idx = { 0 };
+    if (!force_rgb && colors <= 256) {
+        uint16_t *ipix = malloc((size_t)w * h * sizeof(uint16_t));
+        for (int i = 0; i < w * h; i++) ipix[i] = lookup[pix[i]];
+        _encode(&idx, ipix, w, h, 1);
+        free(ipix);
+    }
+
+    int use_idx = idx.len && idx.len + colors * 2 < rgb.len;
+    const out_t *o = use_idx ? &idx : &rgb;
+    if (_write_files(argv[2], argv[3], o, w, h, use_idx ? palette : NULL, colors)) return 1;
+
+    fprintf(stderr, "%s: %dx%d, %d bytes raw, %zu bytes %s\n", argv[2], w, h, w * h * 2,
+            o->len + (use_idx ? colors * 2 : 0), use_idx ? "indexed" : "RGB565");
+
+    free(rgb.buf);
+    free(idx.buf);
+    free(pix);
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "sdk_host.h"
+#include "config.h"
+#include "ll.h"
+#include "os_mem.h"
+#include "os_task.h"
+#include "os_timer.h"
+#include "sys_utils.h"
+#include "driver_gpio.h"
+#include "driver_pmu.h"
+#include "driver_system.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static bool _button;
+static uint64_t _time_us;
+
+void sdk_host_set_button(bool pressed) {
+    _button = pressed;
+}
+
+uint64_t sdk_host_time_us(void) {
+    return _time_us;
+}
+
+// ll.h, there are no interrupts to mask on the host
+
+uint32_t CPU_SR_Save(uint8_t mask) {
+    return 0;
+}
+
+void CPU_SR_Restore(CPU_SR reg) {
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq) {
+}
+
+// sys_utils.h and co_printf.h
+
+void co_delay_100us(uint32_t num) {
+    _time_us += (uint64_t)num * 100;
+}
+
+int co_printf(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = vprintf(format, args);
+    va_end(args);
+    return n;
+}
+
+// os_mem.h
+
+void *ke_malloc(uint32_t size, uint8_t type) {
+    return malloc(size);
+}
+
+void ke_free(void *mem_ptr) {
+    free(mem_ptr);
+}
+
+// driver_system.h, driver_gpio.h and driver_pmu.h
+
+void system_set_port_mux(enum system_port_t port, enum system_port_bit_t bit, uint8_t func) {
+}
+
+void gpio_set_dir(enum system_port_t port, enum system_port_bit_t bit, uint8_t dir) {
+}
+
+uint8_t gpio_get_pin_value(enum system_port_t port, enum system_port_bit_t bit) {
+    if (port == BUTTON_GPIO_PIN_NAME && bit == BUTTON_GPIO_PIN_NUM) return _button;
+    return 0;
+}
+
+void pmu_set_led1_value(uint8_t value) {
+}
+
+void pmu_set_led2_value(uint8_t value) {
+}
+
+void pmu_set_port_mux(enum system_port_t port, enum system_port_bit_t bit, enum pmu_gpio_mux_t func) {
+}
+
+void pmu_set_pin_dir(enum system_port_t port, uint8_t bits, uint8_t dir) {
+}
+
+void pmu_set_gpio_value(enum system_port_t port, uint8_t bits, uint8_t value) {
+}
+
+void pmu_set_pin_to_PMU(enum system_port_t port, uint8_t bits) {
+}
+
+void pmu_set_pin_to_CPU(enum system_port_t port, uint8_t bits) {
+}
+
+void system_sleep_enable(void) {
+}
+
+void system_sleep_disable(void) {
+}
+
+uint32_t system_get_curr_time(void) {
+    return (uint32_t)(_time_us / 1000) % 0x5000000;
+}
+
+// os_task.h and os_timer.h, gfx_sim calls app_update itself so nothing is
+// ever scheduled
+
+uint16_t os_task_create(os_task_func_t task_func) {
+    return 0;
+}
+
+void os_msg_post(uint16_t dst_task_id, os_event_t *evt) {
+}
+
+void os_timer_init(os_timer_t *ptimer, os_timer_func_t pfunction, void *parg) {
+}
+
+void os_timer_start(os_timer_t *ptimer, uint32_t ms, bool repeat_flag) {
+}
+
+void os_timer_stop(os_timer_t *ptimer) {
+}
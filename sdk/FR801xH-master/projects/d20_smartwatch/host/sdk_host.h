@@ -0,0 +1,13 @@
+#ifndef SDK_HOST_H
+#define SDK_HOST_H
+
+// Host stand-ins for the rest of the SDK the project links against. Delays
+// don't sleep, they advance a simulated clock instead.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+void sdk_host_set_button(bool pressed);
+uint64_t sdk_host_time_us(void);        // Time spent in co_delay_100us and friends
+
+#endif // SDK_HOST_H
@@ -0,0 +1,49 @@
+#include "span_rec.h"
+#include "display/gfx.h"
+#include <string.h>
+
+static FILE *_log;
+static span_rec_stats_t _stats;
+
+static void _fill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, void *arg) {
+    const gfx_span_sink_t *sink = gfx_builtin_span_sink();
+
+    _stats.fills++;
+    _stats.fill_pixels += (uint32_t)w * h;
+    if (_log) fprintf(_log, "F %d %d %d %d %04X\n", x, y, w, h, color);
+    sink->fill(x, y, w, h, color, sink->arg);
+}
+
+static void _points(gfx_point_t *pts, uint16_t n, uint16_t color, void *arg) {
+    const gfx_span_sink_t *sink = gfx_builtin_span_sink();
+
+    _stats.batches++;
+    _stats.points += n;
+    if (_log) {
+        fprintf(_log, "P %u %04X", n, color);
+        for (uint16_t i = 0; i < n; i++) fprintf(_log, " %d,%d", pts[i].x, pts[i].y);
+        fputc('\n', _log);
+    }
+    sink->points(pts, n, color, sink->arg);
+}
+
+static const gfx_span_sink_t _sink = { _fill, _points, NULL };
+
+void span_rec_start(FILE *log) {
+    _log = log;
+    span_rec_reset_stats();
+    gfx_set_span_sink(&_sink);
+}
+
+void span_rec_stop(void) {
+    gfx_set_span_sink(NULL);
+    _log = NULL;
+}
+
+void span_rec_stats(span_rec_stats_t *stats) {
+    *stats = _stats;
+}
+
+void span_rec_reset_stats(void) {
+    memset(&_stats, 0, sizeof(_stats));
+}
@@ -0,0 +1,28 @@
+#ifndef SPAN_REC_H
+#define SPAN_REC_H
+
+// Span sink that records what gfx.c hands over before passing it on to the
+// built in sink, so it shows how shapes break down into runs and points
+// independent of the bus. With a log file every call is written out as text:
+//
+//   F x y w h color         rectangle or run
+//   P n color x,y x,y ...   point batch
+
+#include <stdint.h>
+#include <stdio.h>
+
+typedef struct {
+    uint32_t fills;         // Rectangles and runs
+    uint32_t fill_pixels;
+    uint32_t batches;       // Point batches
+    uint32_t points;
+} span_rec_stats_t;
+
+void span_rec_start(FILE *log); // log may be NULL
+void span_rec_stop(void);
+
+// Counters since the last span_rec_reset_stats
+void span_rec_stats(span_rec_stats_t *stats);
+void span_rec_reset_stats(void);
+
+#endif // SPAN_REC_H
@@ -0,0 +1,134 @@
+#include "ssp_host.h"
+#include "config.h"
+#include "driver_ssp.h"
+#include "driver_gpio.h"
+
+static ssp_host_byte_t _log[SSP_HOST_LOG_SIZE];
+static uint32_t _log_count;
+static uint32_t _cs_cycles;
+static ssp_host_sink_t _sink;
+static void *_sink_arg;
+
+static uint8_t _fifo[SSP_FIFO_SIZE];
+static uint32_t _fifo_count;
+static uint8_t _dc = 1;
+static uint8_t _cs = 1;
+static bool _tx_irq;
+
+void ssp_isr_ram(void);
+
+// Shift the whole FIFO out
+static void _drain(void) {
+    for (uint32_t i = 0; i < _fifo_count; i++) {
+        if (_cs) continue;  // Nobody is listening
+        if (_log_count < SSP_HOST_LOG_SIZE) {
+            _log[_log_count].byte = _fifo[i];
+            _log[_log_count].dc = _dc;
+        }
+        _log_count++;
+        if (_sink) _sink(_fifo[i], _dc, _sink_arg);
+    }
+    _fifo_count = 0;
+}
+
+static void _push(uint8_t byte) {
+    if (_fifo_count == SSP_FIFO_SIZE) _drain();
+    _fifo[_fifo_count++] = byte;
+}
+
+void ssp_host_reset(void) {
+    _log_count = 0;
+    _cs_cycles = 0;
+    _fifo_count = 0;
+    _tx_irq = false;
+}
+
+void ssp_host_set_sink(ssp_host_sink_t sink, void *arg) {
+    _sink = sink;
+    _sink_arg = arg;
+}
+
+const ssp_host_byte_t *ssp_host_log(void) {
+    return _log;
+}
+
+uint32_t ssp_host_log_count(void) {
+    return _log_count;
+}
+
+uint32_t ssp_host_cs_cycles(void) {
+    return _cs_cycles;
+}
+
+bool ssp_host_irq_enabled(void) {
+    return _tx_irq;
+}
+
+void ssp_host_run(void) {
+    while (_tx_irq) {
+        _drain();
+        ssp_isr_ram();
+    }
+}
+
+// driver_ssp.h
+
+void ssp_init_(uint8_t bit_width, uint8_t frame_type, uint8_t ms, uint32_t bit_rate, uint8_t prescale, void (*ssp_cs_ctrl)(uint8_t)) {
+    ssp_host_reset();
+}
+
+void ssp_send_byte(const uint16_t tx_value) {
+    _push((uint8_t)tx_value);
+}
+
+void ssp_send_bytes(const uint8_t *tx_buf, uint32_t length) {
+    while (length--) {
+        _push(*tx_buf++);
+    }
+}
+
+void ssp_send_120Bytes(const uint8_t *tx_buf) {
+    ssp_send_bytes(tx_buf, 120);
+}
+
+void ssp_send_data(uint8_t *buffer, uint32_t length) {
+    ssp_send_bytes(buffer, length);
+    _drain();
+}
+
+void ssp_wait_send_end(void) {
+    _drain();
+}
+
+void ssp_put_data_to_fifo(uint8_t *buffer, uint16_t length) {
+    ssp_send_bytes(buffer, length);
+}
+
+void ssp_enable_interrupt(uint8_t ints) {
+    if (ints & SSP_INT_TX_FF) _tx_irq = true;
+}
+
+void ssp_disable_interrupt(uint8_t ints) {
+    if (ints & SSP_INT_TX_FF) _tx_irq = false;
+}
+
+// Time passes whenever the status is read, the FIFO is always empty by then
+uint32_t ssp_get_isr_status(void) {
+    _drain();
+    return _tx_irq ? SSP_INT_STATUS_TX : 0;
+}
+
+void ssp_clear_isr_status(uint32_t status) {
+}
+
+// driver_gpio.h, only the display DC and CS lines matter
+
+void gpio_set_pin_value(enum system_port_t port, enum system_port_bit_t bit, uint8_t value) {
+    // Bytes still in the FIFO go out with the new levels, as on the real bus
+    if (port == DISPLAY_DC_PIN_NAME && bit == DISPLAY_DC_PIN_NUM) {
+        _dc = value ? 1 : 0;
+    } else if (port == DISPLAY_CS_PIN_NAME && bit == DISPLAY_CS_PIN_NUM) {
+        if (_cs && !value) _cs_cycles++;
+        _cs = value ? 1 : 0;
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef SSP_HOST_H
+#define SSP_HOST_H
+
+// Host side stand-in for driver_ssp.c and the display GPIOs. Every byte that
+// reaches the wire is recorded together with the DC level it was sent with,
+// so tests can check exactly what display.c puts on the bus.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef SSP_HOST_LOG_SIZE
+#define SSP_HOST_LOG_SIZE (256 * 1024)
+#endif
+
+typedef struct {
+    uint8_t byte;
+    uint8_t dc;     // 0 command, 1 data
+} ssp_host_byte_t;
+
+// Called for every byte shifted out while CS is low, may be NULL
+typedef void (*ssp_host_sink_t)(uint8_t byte, uint8_t dc, void *arg);
+
+void ssp_host_reset(void);
+void ssp_host_set_sink(ssp_host_sink_t sink, void *arg);
+const ssp_host_byte_t *ssp_host_log(void);
+uint32_t ssp_host_log_count(void);      // Bytes recorded, the log keeps the first SSP_HOST_LOG_SIZE
+uint32_t ssp_host_cs_cycles(void);      // CS assertions
+bool ssp_host_irq_enabled(void);
+
+// Let the bus run until the TX interrupt is disabled, calling ssp_isr_ram()
+// whenever the FIFO drops to half, like the hardware would
+void ssp_host_run(void);
+
+#endif // SSP_HOST_H
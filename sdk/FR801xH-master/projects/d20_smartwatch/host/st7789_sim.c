@@ -0,0 +1,386 @@
+#include "st7789_sim.h"
+#include "ssp_host.h"
+#include "display/display.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ST77XX_RAMWRC     0x3C
+
+static uint16_t _ram[ST7789_SIM_ROWS * ST7789_SIM_COLS];
+
+static uint8_t _cmd;
+static uint8_t _args[4];
+static uint8_t _argn;
+static uint8_t _pix[3];         // Pixel bytes waiting for the rest of the pixel
+static uint8_t _pixn;
+
+static uint16_t _xs, _xe = ST7789_SIM_COLS - 1;
+static uint16_t _ys, _ye = ST7789_SIM_ROWS - 1;
+static uint16_t _cx, _cy;       // Address counter
+static uint8_t _madctl;
+static uint8_t _colmod = 0x66;
+static bool _inverted;
+static bool _display_on;
+static uint16_t _tfa, _vsa = ST7789_SIM_ROWS, _vsp;  // Vertical scroll
+static bool _scrolling;
+static uint16_t _psl, _pel;     // Partial area
+static bool _partial;
+static bool _idle;
+static bool _sleeping = true;
+
+static st7789_sim_stats_t _stats;
+static uint32_t _cs_base;
+
+// Store a pixel at the address counter and advance it through the window
+static void _write_pixel(uint16_t color) {
+    uint16_t col = _cx, row = _cy;
+
+    if (_madctl & ST77XX_MADCTL_MV) {
+        col = _cy;
+        row = _cx;
+    }
+    if (_madctl & ST77XX_MADCTL_MX) col = ST7789_SIM_COLS - 1 - col;
+    if (_madctl & ST77XX_MADCTL_MY) row = ST7789_SIM_ROWS - 1 - row;
+    if (col < ST7789_SIM_COLS && row < ST7789_SIM_ROWS) {
+        _ram[row * ST7789_SIM_COLS + col] = color;
+    }
+    _stats.pixels++;
+
+    if (++_cx > _xe) {
+        _cx = _xs;
+        if (++_cy > _ye) _cy = _ys;
+    }
+}
+
+static uint16_t _expand444(uint8_t r, uint8_t g, uint8_t b) {
+    return ((r << 1 | r >> 3) << 11) | ((g << 2 | g >> 2) << 5) | (b << 1 | b >> 3);
+}
+
+static void _command(uint8_t cmd) {
+    _cmd = cmd;
+    _argn = 0;
+    _pixn = 0;
+    _stats.commands++;
+
+    switch (cmd) {
+    case ST77XX_SWRESET:
+        _madctl = 0;
+        _colmod = 0x66;
+        _inverted = false;
+        _display_on = false;
+        _scrolling = false;
+        _partial = false;
+        _idle = false;
+        _sleeping = true;
+        _tfa = _vsp = 0;
+        _vsa = ST7789_SIM_ROWS;
+        break;
+    case ST77XX_RAMWR:
+        _cx = _xs;
+        _cy = _ys;
+        _stats.windows++;
+        break;
+    case ST77XX_NORON:   _scrolling = false; _partial = false; break;
+    case ST77XX_PTLON:   _scrolling = false; _partial = true; break;
+    case ST77XX_IDMOFF:  _idle = false; break;
+    case ST77XX_IDMON:   _idle = true; break;
+    case ST77XX_SLPIN:   _sleeping = true; break;
+    case ST77XX_SLPOUT:  _sleeping = false; break;
+    case ST77XX_INVOFF:  _inverted = false; break;
+    case ST77XX_INVON:   _inverted = true; break;
+    case ST77XX_DISPOFF: _display_on = false; break;
+    case ST77XX_DISPON:  _display_on = true; break;
+    }
+}
+
+static void _data(uint8_t b) {
+    switch (_cmd) {
+    case ST77XX_CASET:
+    case ST77XX_RASET:
+        if (_argn < 4) _args[_argn++] = b;
+        if (_argn == 4) {
+            uint16_t s = (_args[0] << 8) | _args[1];
+            uint16_t e = (_args[2] << 8) | _args[3];
+            if (_cmd == ST77XX_CASET) {
+                _xs = s;
+                _xe = e;
+            } else {
+                _ys = s;
+                _ye = e;
+            }
+        }
+        break;
+    case ST77XX_VSCRDEF:
+        // TFA, VSA, BFA, the bottom area follows from the other two
+        if (_argn < 4) _args[_argn++] = b;
+        if (_argn == 4) {
+            _tfa = (_args[0] << 8) | _args[1];
+            _vsa = (_args[2] << 8) | _args[3];
+            _argn++;
+        }
+        break;
+    case ST77XX_PTLAR:
+        if (_argn < 4) _args[_argn++] = b;
+        if (_argn == 4) {
+            _psl = (_args[0] << 8) | _args[1];
+            _pel = (_args[2] << 8) | _args[3];
+            _argn++;
+        }
+        break;
+    case ST77XX_VSCSAD:
+        if (_argn < 2) _args[_argn++] = b;
+        if (_argn == 2) {
+            _vsp = (_args[0] << 8) | _args[1];
+            _scrolling = true;
+        }
+        break;
+    case ST77XX_MADCTL:
+        _madctl = b;
+        break;
+    case ST77XX_COLMOD:
+        _colmod = b;
+        break;
+    case ST77XX_RAMWR:
+    case ST77XX_RAMWRC:
+        _pix[_pixn++] = b;
+        if ((_colmod & 0x07) == 0x03) {
+            // 12 bit, two pixels in three bytes, each stored once its bits are in
+            if (_pixn == 2) {
+                _write_pixel(_expand444(_pix[0] >> 4, _pix[0] & 0x0F, _pix[1] >> 4));
+            } else if (_pixn == 3) {
+                _write_pixel(_expand444(_pix[1] & 0x0F, _pix[2] >> 4, _pix[2] & 0x0F));
+                _pixn = 0;
+            }
+        } else if (_pixn == 2) {
+            _write_pixel((_pix[0] << 8) | _pix[1]);
+            _pixn = 0;
+        }
+        break;
+    }
+}
+
+static void _sink(uint8_t byte, uint8_t dc, void *arg) {
+    _stats.bytes++;
+    if (dc) {
+        _data(byte);
+    } else {
+        _command(byte);
+    }
+}
+
+void st7789_sim_init(void) {
+    memset(_ram, 0, sizeof(_ram));
+    _command(ST77XX_SWRESET);
+    _cmd = ST77XX_NOP;
+    _xs = _ys = 0;
+    _xe = ST7789_SIM_COLS - 1;
+    _ye = ST7789_SIM_ROWS - 1;
+    ssp_host_set_sink(_sink, NULL);
+    st7789_sim_reset_stats();
+}
+
+const uint16_t *st7789_sim_ram(void) {
+    return _ram;
+}
+
+uint16_t st7789_sim_pixel(uint16_t col, uint16_t row) {
+    if (col >= ST7789_SIM_COLS || row >= ST7789_SIM_ROWS) return 0;
+    return _ram[row * ST7789_SIM_COLS + col];
+}
+
+uint16_t st7789_sim_shown(uint16_t col, uint16_t row) {
+    if (_sleeping || !_display_on) return 0;
+    // Outside the partial area the panel shows black
+    if (_partial && ((_psl <= _pel) ? (row < _psl || row > _pel) : (row < _psl && row > _pel))) {
+        return 0;
+    }
+    if (_scrolling && row >= _tfa && row < _tfa + _vsa && _vsp >= _tfa && _vsp < _tfa + _vsa) {
+        row = _tfa + (row - _tfa + _vsp - _tfa) % _vsa;
+    }
+    uint16_t c = st7789_sim_pixel(col, row);
+    // Idle mode keeps the top bit of every channel
+    return _idle ? ((c & 0x8000) ? 0xF800 : 0) | ((c & 0x0400) ? 0x07E0 : 0) | ((c & 0x0010) ? 0x001F : 0) : c;
+}
+
+bool st7789_sim_scrolling(void) {
+    return _scrolling;
+}
+
+bool st7789_sim_partial(void) {
+    return _partial;
+}
+
+bool st7789_sim_idle(void) {
+    return _idle;
+}
+
+bool st7789_sim_sleeping(void) {
+    return _sleeping;
+}
+
+uint8_t st7789_sim_madctl(void) {
+    return _madctl;
+}
+
+uint8_t st7789_sim_colmod(void) {
+    return _colmod;
+}
+
+bool st7789_sim_inverted(void) {
+    return _inverted;
+}
+
+bool st7789_sim_display_on(void) {
+    return _display_on;
+}
+
+void st7789_sim_stats(st7789_sim_stats_t *stats) {
+    uint32_t cs = ssp_host_cs_cycles();
+
+    *stats = _stats;
+    // ssp_host_reset clears its counter underneath us
+    stats->cs_cycles = (cs >= _cs_base) ? cs - _cs_base : cs;
+}
+
+void st7789_sim_reset_stats(void) {
+    memset(&_stats, 0, sizeof(_stats));
+    _cs_base = ssp_host_cs_cycles();
+}
+
+// Frame memory as 8 bit RGB
+static uint8_t *_rgb888(uint16_t cols, uint16_t rows) {
+    uint8_t *rgb = malloc((size_t)cols * rows * 3);
+    if (!rgb) return NULL;
+
+    uint8_t *p = rgb;
+    for (uint16_t y = 0; y < rows; y++) {
+        for (uint16_t x = 0; x < cols; x++) {
+            uint16_t c = st7789_sim_shown(x, y);
+            uint8_t r = c >> 11, g = (c >> 5) & 0x3F, b = c & 0x1F;
+            *p++ = (r << 3) | (r >> 2);
+            *p++ = (g << 2) | (g >> 4);
+            *p++ = (b << 3) | (b >> 2);
+        }
+    }
+    return rgb;
+}
+
+int st7789_sim_write_ppm(const char *path, uint16_t cols, uint16_t rows) {
+    uint8_t *rgb = _rgb888(cols, rows);
+    FILE *f = fopen(path, "wb");
+    if (!rgb || !f) {
+        free(rgb);
+        if (f) fclose(f);
+        return -1;
+    }
+
+    fprintf(f, "P6\n%u %u\n255\n", cols, rows);
+    fwrite(rgb, 3, (size_t)cols * rows, f);
+    fclose(f);
+    free(rgb);
+    return 0;
+}
+
+// PNG without zlib, the image data goes in stored deflate blocks
+
+static uint32_t _crc_table[256];
+
+static uint32_t _crc(uint32_t crc, const uint8_t *p, size_t len) {
+    if (!_crc_table[1]) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            _crc_table[n] = c;
+        }
+    }
+    crc = ~crc;
+    while (len--) crc = _crc_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void _put32(uint8_t *p, uint32_t v) {
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+static void _chunk(FILE *f, const char *type, const uint8_t *data, uint32_t len) {
+    uint8_t hdr[8];
+    _put32(hdr, len);
+    memcpy(&hdr[4], type, 4);
+    fwrite(hdr, 1, 8, f);
+    fwrite(data, 1, len, f);
+
+    uint32_t crc = _crc(0, (const uint8_t *)type, 4);
+    crc = _crc(crc, data, len);
+    _put32(hdr, crc);
+    fwrite(hdr, 1, 4, f);
+}
+
+int st7789_sim_write_png(const char *path, uint16_t cols, uint16_t rows) {
+    static const uint8_t sig[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    uint8_t *rgb = _rgb888(cols, rows);
+    if (!rgb) return -1;
+
+    // Filter type 0 in front of every row
+    size_t stride = (size_t)cols * 3 + 1;
+    size_t raw_len = stride * rows;
+    uint8_t *raw = malloc(raw_len);
+    size_t blocks = (raw_len + 65534) / 65535;
+    uint8_t *z = malloc(2 + raw_len + blocks * 5 + 4);
+    if (!raw || !z) {
+        free(rgb);
+        free(raw);
+        free(z);
+        return -1;
+    }
+    for (uint16_t y = 0; y < rows; y++) {
+        raw[y * stride] = 0;
+        memcpy(&raw[y * stride + 1], &rgb[(size_t)y * cols * 3], (size_t)cols * 3);
+    }
+
+    size_t zn = 0;
+    uint32_t a = 1, b = 0;
+    z[zn++] = 0x78;
+    z[zn++] = 0x01;
+    for (size_t off = 0; off < raw_len; ) {
+        uint16_t n = (raw_len - off > 65535) ? 65535 : (uint16_t)(raw_len - off);
+        z[zn++] = (off + n == raw_len) ? 1 : 0;
+        z[zn++] = n & 0xFF;
+        z[zn++] = n >> 8;
+        z[zn++] = ~n & 0xFF;
+        z[zn++] = (uint16_t)~n >> 8;
+        memcpy(&z[zn], &raw[off], n);
+        for (uint16_t i = 0; i < n; i++) {
+            a = (a + raw[off + i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        zn += n;
+        off += n;
+    }
+    _put32(&z[zn], (b << 16) | a);
+    zn += 4;
+
+    uint8_t ihdr[13];
+    _put32(&ihdr[0], cols);
+    _put32(&ihdr[4], rows);
+    ihdr[8] = 8;        // Bit depth
+    ihdr[9] = 2;        // RGB
+    ihdr[10] = ihdr[11] = ihdr[12] = 0;
+
+    FILE *f = fopen(path, "wb");
+    if (f) {
+        fwrite(sig, 1, sizeof(sig), f);
+        _chunk(f, "IHDR", ihdr, sizeof(ihdr));
+        _chunk(f, "IDAT", z, (uint32_t)zn);
+        _chunk(f, "IEND", NULL, 0);
+        fclose(f);
+    }
+
+    free(rgb);
+    free(raw);
+    free(z);
+    return f ? 0 : -1;
+}
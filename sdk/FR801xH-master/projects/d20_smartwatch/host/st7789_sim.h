@@ -0,0 +1,47 @@
+#ifndef ST7789_SIM_H
+#define ST7789_SIM_H
+
+// ST7789 model fed from the ssp_host byte stream. It keeps the controller's
+// 240x320 frame memory and decodes CASET, RASET, RAMWR, RAMWRC, MADCTL and
+// COLMOD into it, so frames drawn by display.c and gfx.c can be dumped and
+// compared off the watch. MADCTL row/column exchange and mirroring are
+// applied, colour order and inversion are only recorded. Vertical scrolling
+// (VSCRDEF, VSCSAD), partial mode, idle mode and sleep change what is shown,
+// not the frame memory.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ST7789_SIM_COLS 240
+#define ST7789_SIM_ROWS 320
+
+typedef struct {
+    uint32_t bytes;         // Every byte with CS low
+    uint32_t commands;      // Bytes sent with DC low
+    uint32_t windows;       // RAMWR commands
+    uint32_t pixels;        // Pixels written to frame memory
+    uint32_t cs_cycles;
+} st7789_sim_stats_t;
+
+void st7789_sim_init(void);     // Power on state, hooks into ssp_host
+const uint16_t *st7789_sim_ram(void);   // RGB565, ST7789_SIM_ROWS rows of ST7789_SIM_COLS
+uint16_t st7789_sim_pixel(uint16_t col, uint16_t row);
+uint16_t st7789_sim_shown(uint16_t col, uint16_t row);  // What the panel lights up
+bool st7789_sim_scrolling(void);
+bool st7789_sim_partial(void);
+bool st7789_sim_idle(void);     // 8 colors
+bool st7789_sim_sleeping(void);
+uint8_t st7789_sim_madctl(void);
+uint8_t st7789_sim_colmod(void);
+bool st7789_sim_inverted(void);
+bool st7789_sim_display_on(void);
+
+// Counters since the last st7789_sim_reset_stats, typically one frame
+void st7789_sim_stats(st7789_sim_stats_t *stats);
+void st7789_sim_reset_stats(void);
+
+// Dump the top rows x cols as shown, which is what a 240x240 panel displays
+int st7789_sim_write_ppm(const char *path, uint16_t cols, uint16_t rows);
+int st7789_sim_write_png(const char *path, uint16_t cols, uint16_t rows);
+
+#endif // ST7789_SIM_H